@@ -20,6 +20,7 @@ class AhoCorasick {
   // indices in the input where the string matches (the index points to the last
   // character of the match, to be precise).
   std::vector<std::vector<int>> feed(std::string_view sv) {
+    PROF_SCOPE("AhoCorasick::feed");
     auto res = std::vector<std::vector<int>>(sz);
     auto curNode = root.get();
     for (int i = 0; i < sv.size(); ++i) {
@@ -27,8 +28,10 @@ class AhoCorasick {
       curNode = curNode->transition[idx];
       if (curNode->tick)
         res[curNode->tickIdx].push_back(i);
-      for (auto node = curNode->dictLink; node; node = node->dictLink)
+      for (auto node = curNode->dictLink; node; node = node->dictLink) {
+        PROF_COUNT("AhoCorasick::dictLinkHop");
         res[node->tickIdx].push_back(i);
+      }
     }
     return res;
   }
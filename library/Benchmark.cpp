@@ -0,0 +1,782 @@
+// Benchmarking harness for the library: deterministic input generators, a
+// timer and a reporter printing one JSON object per line to stdout, e.g.
+//   {"name":"Fenwick/add+sum","shape":"random","n":1000000,"ops":2000000,
+//    "ns_per_op":21.3,"ops_per_sec":46948356.8,"peak_rss_kb":12044}
+// so that the results of two library versions can be diffed/plotted.
+//
+// Usage: paste the file together with the component(s) to benchmark and call
+// the corresponding bench* functions from main, e.g.
+//   for (auto n : benchSizes(10'000'000))
+//     benchFenwick<Fenwick<i64>>(n);
+// The components are template parameters (or callables) since the library
+// files can't all be pasted into a single program. BenchmarkMain.cpp is such a
+// main covering the whole library, "./benchmark.sh [maxN]" does the pasting,
+// compiles it and runs it.
+//
+// Note: peak RSS is the high-water mark of the whole process, so for precise
+// memory numbers run one component (and size) per process.
+//
+// Note: requires Template.cpp (for the generators of graphs, also GraphAlgs.cpp
+// if Neighbor is used as the edge type).
+
+// ------------------------------------------------------------
+// Measurement stuff.
+// ------------------------------------------------------------
+
+// Peak resident set size of the process in KB (or -1 if unavailable).
+long peakRssKb() {
+#if __has_include(<sys/resource.h>)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;  // Already in KB on Linux.
+#endif
+  return -1;
+}
+
+// Used by doNotOptimize on compilers without GNU inline asm.
+inline volatile char benchSink = 0;
+
+// Makes the compiler assume that val gets read (and that any memory might get
+// written), so the computation of val can't be optimized away.
+template <typename T>
+void doNotOptimize(const T& val) {
+#ifdef __GNUC__
+  asm volatile("" : : "r,m"(val) : "memory");
+#else
+  for (int i = 0; i < sizeof(val); ++i)
+    benchSink = benchSink + reinterpret_cast<const volatile char*>(&val)[i];
+#endif
+}
+
+// Runs f (which performs ops operations) once and reports the time it took.
+// Returns the number of seconds.
+template <typename Func>
+double benchmark(std::string_view name, std::string_view shape, const i64 n,
+                 const i64 ops, const Func& f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto end = std::chrono::steady_clock::now();
+  const double sec = std::chrono::duration<double>(end - start).count();
+
+  // Formatted separately, so that std::cout's flags stay untouched.
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(1) << "{\"name\":\"" << name
+     << "\",\"shape\":\"" << shape << "\",\"n\":" << n
+     << ",\"ops\":" << ops << ",\"ns_per_op\":" << sec * 1e9 / ops
+     << ",\"ops_per_sec\":" << ops / sec << ",\"peak_rss_kb\":" << peakRssKb()
+     << "}";
+  std::cout << os.str() << std::endl;
+  return sec;
+}
+
+// Returns the sizes 10^3, 10^4, ..., up to maxN.
+std::vector<int> benchSizes(const int maxN = 10'000'000) {
+  std::vector<int> res;
+  for (i64 n = 1000; n <= maxN; n *= 10)
+    res.push_back(n);
+  return res;
+}
+
+// ------------------------------------------------------------
+// Input generators. All of them are deterministic (given the seed).
+// ------------------------------------------------------------
+
+template <typename T = int>
+std::vector<T> genRandom(const int n, const T lo, const T hi,
+                         const uint64_t seed = 1) {
+  std::mt19937_64 rng(seed);
+  auto dist = std::uniform_int_distribution<T>(lo, hi);
+  auto res = std::vector<T>(n);
+  for (auto& x : res)
+    x = dist(rng);
+  return res;
+}
+
+template <typename T = int>
+std::vector<T> genSorted(const int n) {
+  auto res = std::vector<T>(n);
+  std::iota(res.begin(), res.end(), T(0));
+  return res;
+}
+
+// Only a handful of distinct values (lots of ties).
+template <typename T = int>
+std::vector<T> genFewUnique(const int n, const uint64_t seed = 1) {
+  return genRandom<T>(n, 0, 9, seed);
+}
+
+// Random [lo, hi] ranges with 0 <= lo <= hi < n.
+std::vector<std::pair<int, int>> genRanges(const int n, const int count,
+                                           const uint64_t seed = 1) {
+  std::mt19937_64 rng(seed);
+  std::vector<std::pair<int, int>> res(count);
+  for (auto& [lo, hi] : res) {
+    lo = rng() % n;
+    hi = rng() % n;
+    if (lo > hi)
+      std::swap(lo, hi);
+  }
+  return res;
+}
+
+std::string genRandomString(const int n, const int alphabet = 26,
+                            const uint64_t seed = 1) {
+  std::mt19937_64 rng(seed);
+  std::string res(n, 'a');
+  for (auto& c : res)
+    c = 'a' + rng() % alphabet;
+  return res;
+}
+
+// Worst case for the suffix array (all the doubling rounds are needed) and for
+// Aho-Corasick (long dictionary link chains).
+std::string genRepeatedString(const int n) { return std::string(n, 'a'); }
+
+// Path 0 - 1 - ... - (n-1), the worst case for the recursive DFS's (recursion
+// depth n). With the default 8MB stack, getBridges already overflows on a path
+// of 10^5 vertices, so run those with "ulimit -s unlimited".
+std::vector<std::vector<int>> genPathGraph(const int n) {
+  auto adj = std::vector<std::vector<int>>(n);
+  for (int i = 0; i + 1 < n; ++i) {
+    adj[i].push_back(i + 1);
+    adj[i + 1].push_back(i);
+  }
+  return adj;
+}
+
+// Random tree where the parent of i is chosen uniformly from [0, i).
+std::vector<std::vector<int>> genRandomTree(const int n,
+                                            const uint64_t seed = 1) {
+  std::mt19937_64 rng(seed);
+  auto adj = std::vector<std::vector<int>>(n);
+  for (int i = 1; i < n; ++i) {
+    const int p = rng() % i;
+    adj[p].push_back(i);
+    adj[i].push_back(p);
+  }
+  return adj;
+}
+
+// Random directed graph with m edges. If powerLaw is set, the sources are
+// skewed so that the out-degrees roughly follow a power law.
+std::vector<std::vector<int>> genRandomGraph(const int n, const i64 m,
+                                             const bool powerLaw = false,
+                                             const uint64_t seed = 1) {
+  std::mt19937_64 rng(seed);
+  auto real = std::uniform_real_distribution<double>(0, 1);
+  auto adj = std::vector<std::vector<int>>(n);
+  for (i64 i = 0; i < m; ++i) {
+    int u = rng() % n;
+    if (powerLaw)
+      u = std::min<int>(n - 1, n * std::pow(real(rng), 3));
+    adj[u].push_back(rng() % n);
+  }
+  return adj;
+}
+
+// Same as genRandomGraph, but with weights in [1, maxWeight]. Edge has to be
+// constructible as Edge{vertex, weight}, e.g. Neighbor from GraphAlgs.cpp.
+template <typename Edge>
+std::vector<std::vector<Edge>> genRandomWeightedGraph(
+    const int n, const i64 m, const int maxWeight, const uint64_t seed = 1) {
+  std::mt19937_64 rng(seed);
+  auto adj = std::vector<std::vector<Edge>>(n);
+  for (i64 i = 0; i < m; ++i) {
+    const int u = rng() % n;
+    const int v = rng() % n;
+    adj[u].push_back(Edge{v, int(1 + rng() % maxWeight)});
+  }
+  return adj;
+}
+
+// The same graph in the CSR format (see CsrGraph in Template.cpp).
+template <typename Edge>
+CsrGraph<Edge> toCsr(const std::vector<std::vector<Edge>>& adj) {
+  std::vector<int> from;
+  std::vector<Edge> to;
+  for (int u = 0; u < adj.size(); ++u) {
+    from.insert(from.end(), adj[u].size(), u);
+    to.insert(to.end(), adj[u].begin(), adj[u].end());
+  }
+  return CsrGraph<Edge>(adj.size(), from, to);
+}
+
+// ------------------------------------------------------------
+// Component benchmarks.
+// ------------------------------------------------------------
+
+// Parses n random ints (up to 10^9 in absolute value) from a file, once with
+// an std::ifstream (the same parsing as std::cin with sync_with_stdio(false))
+// and once with the Scanner from Template.cpp.
+void benchScanner(const int n) {
+  const char* tmpDir = std::getenv("TMPDIR");
+  const auto path = std::string(tmpDir ? tmpDir : "/tmp") + "/benchScanner.txt";
+  {
+    std::ofstream out(path);
+    for (auto x : genRandom<int>(n, -1'000'000'000, 1'000'000'000))
+      out << x << ' ';
+  }
+
+  benchmark("istream/int", "random", n, n, [&] {
+    std::ifstream in(path);
+    i64 sum = 0;
+    for (int i = 0, x; i < n; ++i) {
+      in >> x;
+      sum += x;
+    }
+    doNotOptimize(sum);
+  });
+  benchmark("Scanner/int", "random", n, n, [&] {
+    FILE* file = std::fopen(path.c_str(), "r");
+    {
+      Scanner in(file);
+      i64 sum = 0;
+      for (int i = 0, x; i < n; ++i) {
+        in >> x;
+        sum += x;
+      }
+      doNotOptimize(sum);
+    }
+    std::fclose(file);
+  });
+  std::remove(path.c_str());
+}
+
+// Tree is a SegmentTree-like type over the Data/UpdateData from
+// SegmentTree.cpp, e.g. DefSegmentTree. The updates are skipped for the trees
+// that don't support them, e.g. SegmentTree<Data, NoUpdates> only gets built
+// and queried.
+template <typename Tree>
+void benchSegmentTree(const int n,
+                      const std::string_view name = "SegmentTree") {
+  const auto vals = genRandom<i64>(n, 0, 1'000'000'000);
+  const auto ranges = genRanges(n, n);
+  auto init = [&](int i) { return Data{.sum = vals[i], .rangeLen = 1}; };
+
+  std::optional<Tree> tree;
+  benchmark(std::string(name) + "/build", "random", n, n,
+            [&] { tree.emplace(init, n); });
+  benchmark(std::string(name) + "/query", "random", n, n, [&] {
+    for (auto [lo, hi] : ranges)
+      doNotOptimize(tree->query(lo, hi).sum);
+  });
+  if constexpr (Tree::lazy) {
+    benchmark(std::string(name) + "/update", "random", n, n, [&] {
+      for (auto [lo, hi] : ranges)
+        tree->update(lo, hi, UpdateData{.val = 1});
+    });
+  }
+  if constexpr (!std::is_same_v<typename Tree::Update, NoUpdates>) {
+    benchmark(std::string(name) + "/pointUpdate", "random", n, n, [&] {
+      for (auto [lo, hi] : ranges)
+        tree->pointUpdate(lo, UpdateData{.val = 1});
+    });
+  }
+}
+
+// Wide is a WideSegmentTree, e.g. WideSegmentTree<i64, SumOp<i64>>. Runs the
+// queries of benchSegmentTree, and set() in place of its pointUpdate (there
+// are no range updates).
+template <typename Wide>
+void benchWideSegmentTree(const int n,
+                          const std::string_view name = "WideSegmentTree") {
+  const auto vals = genRandom<i64>(n, 0, 1'000'000'000);
+  const auto ranges = genRanges(n, n);
+
+  std::optional<Wide> tree;
+  benchmark(std::string(name) + "/build", "random", n, n,
+            [&] { tree.emplace([&](int i) { return vals[i]; }, n); });
+  benchmark(std::string(name) + "/query", "random", n, n, [&] {
+    for (auto [lo, hi] : ranges)
+      doNotOptimize(tree->query(lo, hi));
+  });
+  benchmark(std::string(name) + "/set", "random", n, n, [&] {
+    for (auto [lo, hi] : ranges)
+      tree->set(lo, vals[hi]);
+  });
+}
+
+// Segment data for clamping with SegmentTree::update_if (see
+// benchSegmentTreeBeats): the sum, the length, the max and the min. Works with
+// any UpdateData with a val member that gets added to every element.
+struct ClampData {
+  i64 sum = 0, rangeLen = 0;
+  i64 max = NEG_INF<i64>, min = POS_INF<i64>;
+
+  friend ClampData operator+(const ClampData& left, const ClampData& right) {
+    return ClampData{.sum = left.sum + right.sum,
+                     .rangeLen = left.rangeLen + right.rangeLen,
+                     .max = std::max(left.max, right.max),
+                     .min = std::min(left.min, right.min)};
+  }
+
+  template <typename Upd>
+  friend ClampData& operator+=(ClampData& data, const Upd& upd) {
+    if (data.rangeLen == 0)
+      return data;
+    data.sum += upd.val * data.rangeLen;
+    data.max += upd.val;
+    data.min += upd.val;
+    return data;
+  }
+};
+
+// The adversarial workload for update_if: n alternating 0/10^9 values, each
+// operation clamps the whole range with a bound one smaller than before. The
+// pred of update_if can't tell anything about a node holding both a 0 and a
+// high value, so every operation visits all the high leaves. Beats (e.g.
+// SegmentTreeBeats<i64>) does the same with chmin in amortized O(lgn), while
+// Tree is SegmentTree<ClampData, UpdateData> (which only gets about 5 * 10^7 /
+// n operations, since each of them is O(n)).
+template <typename Beats, typename Tree>
+void benchSegmentTreeBeats(const int n) {
+  const i64 high = 1'000'000'000;
+  const auto init = [&](int i) { return (i % 2 == 0) ? i64(0) : high; };
+
+  Beats beats(init, n);
+  benchmark("SegmentTreeBeats/chmin", "alternating", n, n, [&] {
+    for (int i = 1; i <= n; ++i)
+      beats.chmin(0, n - 1, high - i);
+    doNotOptimize(beats.querySum(0, n - 1));
+  });
+
+  const int ops = std::clamp(50'000'000 / n, 1, n);
+  Tree tree(
+      [&](int i) {
+        return ClampData{
+            .sum = init(i), .rangeLen = 1, .max = init(i), .min = init(i)};
+      },
+      n);
+  benchmark("SegmentTree/update_if-clamp", "alternating", n, ops, [&] {
+    for (int i = 1; i <= ops; ++i) {
+      // All the high values are equal to high - i + 1, clamp them to
+      // high - i.
+      const i64 bound = high - i;
+      tree.update_if(0, n - 1, {.val = -1}, [&](const ClampData& data) {
+        if (data.max <= bound)
+          return -1;
+        return (data.min == data.max) ? 1 : 0;
+      });
+    }
+    doNotOptimize(tree.query(0, n - 1).sum);
+  });
+}
+
+// Applies n random range updates to a Tree with applyBatch (see SegmentTree),
+// both in the ordered and in the commutative mode, then answers n random range
+// queries with queryBatch. Compare with "name/update" and "name/query" of
+// benchSegmentTree.
+template <typename Tree>
+void benchSegmentTreeBatch(const int n,
+                           const std::string_view name = "SegmentTree") {
+  std::vector<typename Tree::RangeUpdate> upds;
+  const auto ranges = genRanges(n, n);
+  for (const auto& [lo, hi] : ranges)
+    upds.push_back({lo, hi, UpdateData{.val = 1}});
+  auto init = [](int) { return Data{.sum = 0, .rangeLen = 1}; };
+
+  for (const bool commutative : {false, true}) {
+    Tree tree(init, n);
+    benchmark(std::string(name) +
+                  (commutative ? "/applyBatch-commutative" : "/applyBatch"),
+              "random", n, n, [&] {
+                tree.applyBatch(upds, commutative);
+                doNotOptimize(tree.query(0, n - 1).sum);
+              });
+  }
+
+  // Queried after the updates, like in benchSegmentTree.
+  Tree tree(init, n);
+  tree.applyBatch(upds, true);
+  benchmark(std::string(name) + "/queryBatch", "random", n, n,
+            [&] { doNotOptimize(tree.queryBatch(ranges).size()); });
+}
+
+// 1469F-style workload: starting from all zeros, n / 2 random range adds, each
+// followed by a search for the first index where the prefix sum reaches a
+// random k (at most the total sum). Done once with lowerBound and once with
+// maxRight (which lowerBound wraps), each on its own Tree.
+template <typename Tree>
+void benchSegmentTreeSearch(const int n,
+                            const std::string_view name = "SegmentTree") {
+  const int ops = std::max(n / 2, 1);
+  const auto ranges = genRanges(n, ops);
+  const auto rnds = genRandom<i64>(ops, 0, POS_INF<i64>, 3);
+  auto init = [](int) { return Data{.sum = 0, .rangeLen = 1}; };
+
+  // Both trees are built before the timing: a pointer-based tree built after
+  // another one got freed is about 25% slower at 10^6.
+  std::array<std::optional<Tree>, 2> trees;
+  for (auto& tree : trees)
+    tree.emplace(init, n);
+  for (const bool useMaxRight : {false, true}) {
+    auto& tree = *trees[useMaxRight];
+    i64 total = 0;
+    benchmark(std::string(name) + (useMaxRight ? "/maxRight" : "/lowerBound"),
+              "1469F", n, 2 * i64(ops), [&] {
+                for (int i = 0; i < ops; ++i) {
+                  const auto [lo, hi] = ranges[i];
+                  tree.update(lo, hi, UpdateData{.val = 1});
+                  total += hi - lo + 1;
+                  const i64 k = 1 + rnds[i] % total;
+                  if (useMaxRight) {
+                    doNotOptimize(tree.maxRight(
+                        0, [&](const Data& acc) { return acc.sum < k; }));
+                  } else {
+                    doNotOptimize(tree.lowerBound(
+                        0, Data{.sum = k},
+                        [](const Data& left, const Data& right) {
+                          return left.sum < right.sum;
+                        }));
+                  }
+                }
+              });
+  }
+}
+
+// Fen is a Fenwick-like type, e.g. Fenwick<i64>.
+template <typename Fen>
+void benchFenwick(const int n, const std::string_view name = "Fenwick") {
+  const auto vals = genRandom<i64>(n, 0, 1000);
+  const auto idxs = genRandom<int>(n, 0, n - 1, 2);
+
+  std::optional<Fen> fen;
+  benchmark(std::string(name) + "/build", "random", n, n,
+            [&] { fen.emplace(vals); });
+  benchmark(std::string(name) + "/add+sum", "random", n, 2 * i64(n), [&] {
+    for (auto i : idxs) {
+      fen->add(i, 1);
+      doNotOptimize(fen->sum(i));
+    }
+  });
+  const auto total = fen->sum(n - 1);
+  const auto targets = genRandom<i64>(n, 1, std::max<i64>(1, total), 3);
+  benchmark(std::string(name) + "/lowerBound", "random", n, n, [&] {
+    for (auto target : targets)
+      doNotOptimize(fen->lowerBound(target));
+  });
+  // The batch version (see PaddedFenwick), if Fen has one.
+  if constexpr (requires { fen->lowerBound(targets); }) {
+    benchmark(std::string(name) + "/lowerBound-batched", "random", n, n,
+              [&] { doNotOptimize(fen->lowerBound(targets).size()); });
+  }
+}
+
+// Fen is a RangeFenwick-like type, e.g. RangeFenwick<i64>. Runs the same
+// workload as benchSegmentTree (with DefSegmentTree), so the two are directly
+// comparable.
+template <typename Fen>
+void benchRangeFenwick(const int n,
+                       const std::string_view name = "RangeFenwick") {
+  const auto vals = genRandom<i64>(n, 0, 1'000'000'000);
+  const auto ranges = genRanges(n, n);
+
+  std::optional<Fen> fen;
+  benchmark(std::string(name) + "/build", "random", n, n,
+            [&] { fen.emplace(vals); });
+  benchmark(std::string(name) + "/query", "random", n, n, [&] {
+    for (auto [lo, hi] : ranges)
+      doNotOptimize(fen->sum(lo, hi));
+  });
+  benchmark(std::string(name) + "/update", "random", n, n, [&] {
+    for (auto [lo, hi] : ranges)
+      fen->add(lo, hi, 1);
+  });
+}
+
+// Static merge-sort tree over weighted points, the baseline for
+// benchCompressedFenwick2D. The points are sorted by x, and level k keeps every
+// aligned block of 2^k of them sorted by y, along with the prefix sums of the
+// weights over the whole level. A rectangle sum binary searches the y bounds in
+// the O(lgn) blocks that make up the x range, so it runs in O(lg^2n).
+template <typename T, typename Coord = int>
+class MergeSortTree2D {
+ public:
+  MergeSortTree2D(const std::vector<std::pair<Coord, Coord>>& points,
+                  const std::vector<T>& weights) {
+    const int n = points.size();
+    auto order = std::vector<int>(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int i, int j) {
+      return points[i].first < points[j].first;
+    });
+    auto level = std::vector<std::pair<Coord, T>>(n);
+    for (int i = 0; i < n; ++i) {
+      xs.push_back(points[order[i]].first);
+      level[i] = {points[order[i]].second, weights[order[i]]};
+    }
+    for (int len = 1;; len *= 2) {
+      ys.emplace_back(n);
+      sums.emplace_back(n + 1, T(0));
+      for (int i = 0; i < n; ++i) {
+        ys.back()[i] = level[i].first;
+        sums.back()[i + 1] = sums.back()[i] + level[i].second;
+      }
+      if (len >= n)
+        break;
+      auto next = std::vector<std::pair<Coord, T>>(n);
+      for (int lo = 0; lo < n; lo += 2 * len) {
+        const int mid = std::min(lo + len, n), hi = std::min(lo + 2 * len, n);
+        std::merge(level.begin() + lo, level.begin() + mid, level.begin() + mid,
+                   level.begin() + hi, next.begin() + lo);
+      }
+      level = std::move(next);
+    }
+  }
+
+  // Returns the sum of the points in the rectangle [x1, x2] x [y1, y2].
+  T sum(Coord x1, Coord y1, Coord x2, Coord y2) const {
+    int lo = std::lower_bound(xs.begin(), xs.end(), x1) - xs.begin();
+    int hi = std::upper_bound(xs.begin(), xs.end(), x2) - xs.begin();
+    T res = 0;
+    // Both lo and hi are multiples of 2^k at level k.
+    for (int k = 0; lo < hi; ++k) {
+      if ((lo >> k) & 1) {
+        res += blockSum(k, lo, y1, y2);
+        lo += 1 << k;
+      }
+      if ((lo < hi) && ((hi >> k) & 1)) {
+        hi -= 1 << k;
+        res += blockSum(k, hi, y1, y2);
+      }
+    }
+    return res;
+  }
+
+ private:
+  std::vector<Coord> xs;
+  std::vector<std::vector<Coord>> ys;
+  std::vector<std::vector<T>> sums;
+
+  // The sum of the points with y in [y1, y2] in the block [first, first + 2^k)
+  // of level k.
+  T blockSum(int k, int first, Coord y1, Coord y2) const {
+    const auto begin = ys[k].begin() + first, end = begin + (1 << k);
+    const int lo = std::lower_bound(begin, end, y1) - ys[k].begin();
+    const int hi = std::upper_bound(begin, end, y2) - ys[k].begin();
+    return sums[k][hi] - sums[k][lo];
+  }
+};
+
+// Fen2D is a CompressedFenwick2D-like type, e.g. CompressedFenwick2D<i64>.
+// Runs rectangle sums over n random weighted points with coordinates up to
+// 10^9, and the same build and queries on MergeSortTree2D (which doesn't
+// support the adds).
+template <typename Fen2D>
+void benchCompressedFenwick2D(
+    const int n, const std::string_view name = "CompressedFenwick2D") {
+  const int maxCoord = 1'000'000'000;
+  const auto xs = genRandom<int>(n, 0, maxCoord, 1);
+  const auto ys = genRandom<int>(n, 0, maxCoord, 2);
+  const auto weights = genRandom<i64>(n, 0, 1000, 3);
+  auto points = std::vector<std::pair<int, int>>(n);
+  for (int i = 0; i < n; ++i)
+    points[i] = {xs[i], ys[i]};
+  // Random rectangles, as (x1, x2) and (y1, y2) ranges.
+  const auto bounds = genRandom<int>(4 * n, 0, maxCoord, 4);
+  auto rects = std::vector<std::array<int, 4>>(n);
+  for (int i = 0; i < n; ++i) {
+    rects[i] = {std::min(bounds[4 * i], bounds[4 * i + 1]),
+                std::min(bounds[4 * i + 2], bounds[4 * i + 3]),
+                std::max(bounds[4 * i], bounds[4 * i + 1]),
+                std::max(bounds[4 * i + 2], bounds[4 * i + 3])};
+  }
+
+  std::optional<Fen2D> fen;
+  benchmark(std::string(name) + "/build", "random", n, n,
+            [&] { fen.emplace(points, weights); });
+  benchmark(std::string(name) + "/query", "random", n, n, [&] {
+    for (const auto& [x1, y1, x2, y2] : rects)
+      doNotOptimize(fen->sum(x1, y1, x2, y2));
+  });
+  benchmark(std::string(name) + "/add", "random", n, n, [&] {
+    for (const auto& [x, y] : points)
+      fen->add(x, y, 1);
+  });
+  fen.reset();
+
+  std::optional<MergeSortTree2D<i64>> mst;
+  benchmark("MergeSortTree2D/build", "random", n, n,
+            [&] { mst.emplace(points, weights); });
+  benchmark("MergeSortTree2D/query", "random", n, n, [&] {
+    for (const auto& [x1, y1, x2, y2] : rects)
+      doNotOptimize(mst->sum(x1, y1, x2, y2));
+  });
+}
+
+// Rmq is an RMQ-like type, e.g. RMQ<int>.
+template <typename Rmq>
+void benchRMQ(const int n, const std::string_view name = "RMQ") {
+  const auto vals = genRandom<int>(n, 0, 1'000'000'000);
+  const auto ranges = genRanges(n, n);
+
+  std::optional<Rmq> rmq;
+  benchmark(std::string(name) + "/build", "random", n, n,
+            [&] { rmq.emplace(vals); });
+  benchmark(std::string(name) + "/query", "random", n, n, [&] {
+    for (auto [lo, hi] : ranges)
+      doNotOptimize(rmq->getMin(lo, hi));
+  });
+}
+
+// Map is HashMap (or std::unordered_map for comparison) with int values and
+// Key (int or std::pair<int, int>) keys. Inserts n distinct random keys, then
+// updates them through operator[] and looks up n present and n absent keys.
+template <typename Map, typename Key = int>
+void benchHashMap(const int n, const std::string_view name = "HashMap") {
+  const auto toKey = [](const int x) {
+    if constexpr (std::is_same_v<Key, int>)
+      return x;
+    else
+      return Key(x, x >> 3);
+  };
+  // The inserted keys are even and the missing ones odd.
+  auto xs = genRandom<int>(n, 0, 1 << 29);
+  std::sort(xs.begin(), xs.end());
+  xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+  std::shuffle(xs.begin(), xs.end(), std::mt19937_64(1));
+  std::vector<Key> present, absent;
+  for (const int x : xs) {
+    present.push_back(toKey(2 * x));
+    absent.push_back(toKey(2 * x + 1));
+  }
+
+  Map map;
+  const int m = present.size();
+  benchmark(std::string(name) + "/insert", "random", n, m, [&] {
+    for (int i = 0; i < m; ++i)
+      map[present[i]] = i;
+    doNotOptimize(map.size());
+  });
+  benchmark(std::string(name) + "/update", "random", n, m, [&] {
+    for (const auto& key : present)
+      ++map[key];
+    doNotOptimize(map.size());
+  });
+  benchmark(std::string(name) + "/hit", "random", n, m, [&] {
+    int found = 0;
+    for (const auto& key : present)
+      found += map.count(key);
+    doNotOptimize(found);
+  });
+  benchmark(std::string(name) + "/miss", "random", n, m, [&] {
+    int found = 0;
+    for (const auto& key : absent)
+      found += map.count(key);
+    doNotOptimize(found);
+  });
+}
+
+// UF is a UnionFind-like type, e.g. UnionFind from UnionFindVector.cpp.
+template <typename UF>
+void benchUnionFind(const int n, const std::string_view name = "UnionFind") {
+  const auto us = genRandom<int>(n, 0, n - 1, 1);
+  const auto vs = genRandom<int>(n, 0, n - 1, 2);
+
+  UF uf(n);
+  benchmark(std::string(name) + "/unionize+getSet", "random", n, 2 * i64(n),
+            [&] {
+              for (int i = 0; i < n; ++i) {
+                uf.unionize(us[i], vs[i]);
+                doNotOptimize(uf.getSet(vs[i]));
+              }
+            });
+}
+
+// SA is a SuffixArray-like type.
+template <typename SA>
+void benchSuffixArray(const int n,
+                      const std::string_view name = "SuffixArray") {
+  const auto shapes = {std::make_pair("random", genRandomString(n)),
+                       std::make_pair("aaaa", genRepeatedString(n))};
+  for (const auto& [shape, str] : shapes) {
+    benchmark(std::string(name) + "/build", shape, n, n, [&] {
+      SA sa(str, SA::Mode::endSmall);
+      doNotOptimize(sa.suffArr[0]);
+    });
+  }
+}
+
+// AC is an AhoCorasick-like type. The dictionary consists of n / 100 words of
+// length up to 100.
+//
+// Note: in the "aaaa" shape every position matches up to 100 words, so the
+// output of feed() alone takes ~400 bytes per text character.
+template <typename AC>
+void benchAhoCorasick(const int n,
+                      const std::string_view name = "AhoCorasick") {
+  for (const auto* shape : {"random", "aaaa"}) {
+    const bool worst = (std::string_view(shape) == "aaaa");
+    const auto text = worst ? genRepeatedString(n) : genRandomString(n, 4);
+    std::vector<std::string> dict;
+    std::mt19937_64 rng(1);
+    for (int i = 0; i < std::max(1, n / 100); ++i) {
+      const int len = 1 + rng() % 100;
+      dict.push_back(worst ? std::string(len, 'a')
+                           : genRandomString(len, 4, i));
+    }
+    AC ac(dict);
+    benchmark(std::string(name) + "/feed", shape, n, n,
+              [&] { doNotOptimize(ac.feed(text).size()); });
+  }
+}
+
+// dijkstraFn(adj, s) runs the single source Dijkstra, e.g.
+//   [](const auto& adj, int s) { return dijkstra(adj, s); }
+// Runs it both on the vector-of-vectors graph and on the same graph in the CSR
+// format.
+template <typename Edge, typename DijkstraFn>
+void benchDijkstra(const int n, const DijkstraFn& dijkstraFn,
+                   const std::string_view name = "dijkstra") {
+  const auto adj = genRandomWeightedGraph<Edge>(n, 5 * i64(n), 1'000'000);
+  benchmark(name, "random", n, 6 * i64(n),
+            [&] { doNotOptimize(dijkstraFn(adj, 0).size()); });
+  const auto csr = toCsr(adj);
+  benchmark(std::string(name) + "/csr", "random", n, 6 * i64(n),
+            [&] { doNotOptimize(dijkstraFn(csr, 0).size()); });
+}
+
+// graphFn(adj) runs some traversal of an undirected graph, e.g.
+//   [](const auto& adj) { return getBridges(adj); }
+template <typename GraphFn>
+void benchGraphTraversal(const int n, const GraphFn& graphFn,
+                         const std::string_view name) {
+  const auto shapes = {std::make_pair("random-tree", genRandomTree(n)),
+                       std::make_pair("path", genPathGraph(n))};
+  for (const auto& [shape, adj] : shapes) {
+    benchmark(name, shape, n, n,
+              [&] { doNotOptimize(graphFn(adj).size()); });
+  }
+}
+
+// graphFn(adj) runs some traversal of a directed graph, e.g.
+//   [](const auto& adj) { return stronglyConnectedComponents(adj).first; }
+// Compares the vector-of-vectors layout ("name/vector") with the CSR layout
+// ("name/csr") on a uniformly random graph and on one with power-law
+// out-degrees, both with 5n edges.
+template <typename GraphFn>
+void benchGraphLayouts(const int n, const GraphFn& graphFn,
+                       const std::string_view name) {
+  for (const bool powerLaw : {false, true}) {
+    const auto shape = powerLaw ? "power-law" : "random";
+    const auto adj = genRandomGraph(n, 5 * i64(n), powerLaw);
+    benchmark(std::string(name) + "/vector", shape, n, 6 * i64(n),
+              [&] { doNotOptimize(graphFn(adj).size()); });
+    const auto csr = toCsr(adj);
+    benchmark(std::string(name) + "/csr", shape, n, 6 * i64(n),
+              [&] { doNotOptimize(graphFn(csr).size()); });
+  }
+}
+
+// sortFn(vec) returns the sorted vec, e.g. sortedCopy<int>.
+template <typename SortFn>
+void benchSort(const int n, const SortFn& sortFn,
+               const std::string_view name = "sortedCopy") {
+  const auto shapes = {std::make_pair("sorted", genSorted<int>(n)),
+                       std::make_pair("random", genRandom<int>(n, 0, 1 << 30)),
+                       std::make_pair("few-unique", genFewUnique<int>(n))};
+  for (const auto& [shape, vec] : shapes) {
+    benchmark(name, shape, n, n,
+              [&] { doNotOptimize(sortFn(vec).size()); });
+  }
+}
@@ -0,0 +1,55 @@
+// Runs the benchmarks of Benchmark.cpp for every library component on the
+// sizes 10^3, 10^4, ..., maxN, where maxN is the first command line argument
+// (10^6 by default). The output is one JSON object per line, so two versions
+// of the library can be compared with e.g.
+//   ./benchmark.sh > before.jsonl; (change stuff); ./benchmark.sh > after.jsonl
+//
+// Note: requires Template.cpp, HashMap.cpp, RMQ.cpp, Fenwick.cpp,
+// SegmentTree.cpp, SegmentTreeBeats.cpp, UnionFindVector.cpp, SuffixArray.cpp,
+// AhoCorasick.cpp, GraphAlgs.cpp and Benchmark.cpp (benchmark.sh pastes them
+// together).
+int main(int argc, char** argv) {
+  const int maxN = (argc > 1) ? std::atoi(argv[1]) : 1'000'000;
+  for (const int n : benchSizes(maxN)) {
+    benchScanner(n);
+    benchSegmentTree<DefSegmentTree>(n);
+    benchSegmentTree<SegmentTree<Data, NoUpdates>>(n, "SegmentTree<NoUpdates>");
+    benchSegmentTreeBatch<DefSegmentTree>(n);
+    benchSegmentTreeSearch<DefSegmentTree>(n);
+    benchSegmentTreeBeats<SegmentTreeBeats<i64>,
+                          SegmentTree<ClampData, UpdateData>>(n);
+    benchSegmentTree<DefFlatSegmentTree>(n, "FlatSegmentTree");
+    benchSegmentTree<FlatSegmentTree<Data, NoUpdates>>(
+        n, "FlatSegmentTree<NoUpdates>");
+    benchSegmentTreeSearch<DefFlatSegmentTree>(n, "FlatSegmentTree");
+    benchWideSegmentTree<WideSegmentTree<i64, SumOp<i64>>>(n);
+    benchFenwick<Fenwick<i64>>(n);
+    benchFenwick<PaddedFenwick<i64>>(n, "PaddedFenwick");
+    benchRangeFenwick<RangeFenwick<i64>>(n);
+    benchCompressedFenwick2D<CompressedFenwick2D<i64>>(n);
+    benchRMQ<RMQ<int>>(n);
+    benchRMQ<LinearRMQ<int>>(n, "LinearRMQ");
+    benchHashMap<HashMap<int, int>>(n);
+    benchHashMap<std::unordered_map<int, int, custom_hash>>(n, "unordered_map");
+    benchHashMap<HashMap<std::pair<int, int>, int>, std::pair<int, int>>(
+        n, "HashMap<pair>");
+    benchHashMap<std::unordered_map<std::pair<int, int>, int, pair_hash>,
+                 std::pair<int, int>>(n, "unordered_map<pair>");
+    benchUnionFind<UnionFind>(n);
+    benchSuffixArray<SuffixArray>(n);
+    benchAhoCorasick<AhoCorasick>(n);
+    benchDijkstra<Neighbor>(
+        n, [](const auto& adj, int s) { return dijkstra(adj, s); });
+    benchGraphTraversal(
+        n, [](const auto& adj) { return getBridges(adj); }, "getBridges");
+    benchGraphTraversal(
+        n,
+        [](const auto& adj) { return stronglyConnectedComponents(adj).first; },
+        "stronglyConnectedComponents");
+    benchGraphLayouts(
+        n,
+        [](const auto& adj) { return stronglyConnectedComponents(adj).first; },
+        "stronglyConnectedComponents");
+    benchSort(n, [](const std::vector<int>& vec) { return sortedCopy(vec); });
+  }
+}
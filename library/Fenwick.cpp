@@ -20,20 +20,36 @@ constexpr inline T lsb(T x) {
 
 // Note: the tree is 0-indexed and prefix sums are inclusive.
 //
-// All operations (except for the construction) run in O(lgn).
+// All operations (except for the construction, which is O(n)) run in O(lgn).
 //
 // For an example, see Codeforces Task 992E--Nastya and King-Shamans.
 template <typename T>
 class Fenwick {
  public:
-  Fenwick(int noElements)
-      : size(noElements + 1),
-        lastPower(msb(size)),
-        tree(2 * lastPower + 1, 0) {}  // Possible overflow if size too large.
+  Fenwick(int noElements) { reset(noElements); }
 
-  Fenwick(const std::vector<T>& vec) : Fenwick(vec.size()) {
-    for (int i = 0; i < vec.size(); ++i)
-      add(i, vec[i]);
+  Fenwick(const std::vector<T>& vec) { rebuild(vec); }
+
+  // Resets the tree to noElements zeros. Reuses the existing storage, so
+  // nothing gets allocated unless the tree grows beyond its largest size so
+  // far (handy for inputs with many test cases).
+  void reset(int noElements) {
+    size = noElements + 1;
+    lastPower = msb(size);
+    tree.assign(2 * lastPower + 1, 0);  // Possible overflow if size too large.
+  }
+
+  // Same as reset, except the tree gets filled with the entries of vec. Runs in
+  // O(n) time: each node passes its (final) value on to its parent, which is
+  // the next node that add() would touch.
+  void rebuild(const std::vector<T>& vec) {
+    reset(vec.size());
+    std::copy(vec.begin(), vec.end(), tree.begin() + 1);
+    for (int idx = 1; idx < tree.size(); ++idx) {
+      const int parent = idx + lsb(idx);
+      if (parent < tree.size())
+        tree[parent] += tree[idx];
+    }
   }
 
   // Returns the prefix sum of [0, idx].
@@ -48,14 +64,27 @@ class Fenwick {
   // be monotonically non-decreasing (i.e. all entries >= 0).
   int lowerBound(T target) { return actualLowerBound(target) - 1; }
 
-  // Returns the element at the given index.
-  // Note: this runs in O(lgn) time which is asymptotically optimal, but there
-  // is a neater way to do it, which yields a better constant factor, see
+  // Returns the element at the given index (0 for idx < 0, like sum).
+  // Note: instead of sum(idx) - sum(idx - 1), this only walks the two paths
+  // until they meet, which is O(1) amortized over all the indices (and O(lgn)
+  // in the worst case), see
   // https://www.topcoder.com/community/competitive-programming/tutorials/binary-indexed-trees/.
-  T getElement(int idx) const { return sum(idx) - sum(idx - 1); }
+  T getElement(int idx) const {
+    if (idx < 0)
+      return T();
+    ++idx;
+    T res = tree[idx];
+    // The path of idx - 1 meets the path of idx at idx with its lsb unset.
+    const int meet = idx & (idx - 1);
+    for (int prev = idx - 1; prev != meet; prev &= (prev - 1))
+      res -= tree[prev];
+    return res;
+  }
 
-  // Sets the element at the given index.
+  // Sets the element at the given index (does nothing for idx < 0).
   void setElement(int idx, T val) {
+    if (idx < 0)
+      return;
     const auto delta = val - getElement(idx);
     add(idx, delta);
   }
@@ -64,9 +93,9 @@ class Fenwick {
   // The number of elements in the tree + 1 (the +1 is since we do 1-indexing so
   // tree[0] is not a part of the tree). Note that that is different from the
   // underlying structure size, i.e., size != tree.size().
-  const int size;
+  int size;
   // Largest power of two occuring in the size of the tree.
-  const int lastPower;
+  int lastPower;
   // Note that internally, the tree is 1-indexed. (Also, the constructor
   // allocates too large a vector for powers of two, but it doesn't matter cause
   // it still allocates O(n) space.)
@@ -98,4 +127,440 @@ class Fenwick {
     // we need to make sure the returned index is not too large.
     return std::min(idx + 1, size);
   }
+};
+
+// Fenwick tree supporting range additions and range sums, using two Fenwick
+// trees over the differences d_i = a_i - a_{i-1}: since
+//   a_0 + ... + a_idx = sum_{i <= idx} (idx + 1 - i) * d_i,
+// it suffices to keep the prefix sums of d_i and of i * d_i.
+//
+// All operations (except for the construction, which is O(n)) run in O(lgn).
+// Whenever the lazy min/max of DefSegmentTree are not needed, use this instead
+// for range add/range sum, it's several times faster.
+//
+// Note: T must be able to hold n * (the largest sum), as the second tree
+// stores the i * d_i.
+template <typename T>
+class RangeFenwick {
+ public:
+  RangeFenwick(int noElements) : diffs(noElements), weighted(noElements) {}
+
+  RangeFenwick(const std::vector<T>& vec) : diffs(1), weighted(1) {
+    rebuild(vec);
+  }
+
+  // Resets to noElements zeros, reusing the existing storage.
+  void reset(int noElements) {
+    diffs.reset(noElements);
+    weighted.reset(noElements);
+  }
+
+  // Rebuilds from the entries of vec in O(n) time.
+  void rebuild(const std::vector<T>& vec) {
+    scratch.resize(vec.size());
+    for (int i = 0; i < vec.size(); ++i)
+      scratch[i] = vec[i] - (i > 0 ? vec[i - 1] : T(0));
+    diffs.rebuild(scratch);
+    for (int i = 0; i < vec.size(); ++i)
+      scratch[i] *= i;
+    weighted.rebuild(scratch);
+  }
+
+  // Adds k to all the elements in [lo, hi].
+  void add(int lo, int hi, T k) {
+    diffs.add(lo, k);
+    diffs.add(hi + 1, -k);
+    weighted.add(lo, k * lo);
+    weighted.add(hi + 1, -k * (hi + 1));
+  }
+
+  // Returns the prefix sum of [0, idx] (0 for idx < 0).
+  T sum(int idx) const {
+    return diffs.sum(idx) * (idx + 1) - weighted.sum(idx);
+  }
+
+  // Returns the sum of [lo, hi].
+  T sum(int lo, int hi) const { return sum(hi) - sum(lo - 1); }
+
+  // Returns the element at the given index in O(lgn) time.
+  T getElement(int idx) const { return diffs.sum(idx); }
+
+ private:
+  Fenwick<T> diffs;
+  Fenwick<T> weighted;
+  // The differences passed to Fenwick::rebuild.
+  std::vector<T> scratch;
+};
+
+// Dense 2D Fenwick tree over a rows x cols grid, 0-indexed, with inclusive
+// prefix sums. Uses O(rows * cols) memory, so only for small grids, see
+// CompressedFenwick2D below for sparse coordinates.
+//
+// Note: requires Matrix from Template.cpp.
+//
+// All operations (except for the construction) run in O(lg(rows) lg(cols)).
+template <typename T>
+class Fenwick2D {
+ public:
+  Fenwick2D(int rows, int cols) : tree(rows + 1, cols + 1, T(0)) {}
+
+  // Adds k to the element at (row, col).
+  void add(int row, int col, T k) {
+    for (int r = row + 1; r < tree.rows(); r += lsb(r)) {
+      for (int c = col + 1; c < tree.cols(); c += lsb(c))
+        tree(r, c) += k;
+    }
+  }
+
+  // Returns the sum of the rectangle [0, row] x [0, col] (0 if row < 0 or
+  // col < 0).
+  T sum(int row, int col) const {
+    T res = 0;
+    for (int r = row + 1; r > 0; r &= (r - 1)) {
+      for (int c = col + 1; c > 0; c &= (c - 1))
+        res += tree(r, c);
+    }
+    return res;
+  }
+
+  // Returns the sum of the rectangle [row1, row2] x [col1, col2].
+  T sum(int row1, int col1, int row2, int col2) const {
+    return sum(row2, col2) - sum(row1 - 1, col2) - sum(row2, col1 - 1) +
+           sum(row1 - 1, col1 - 1);
+  }
+
+ private:
+  // 1-indexed in both dimensions, row and column 0 are unused.
+  Matrix<T> tree;
+};
+
+// 2D Fenwick tree over sparse points (x, y) with arbitrary (e.g. up to 10^9)
+// coordinates, where all the points that will ever be updated are known in
+// advance. The outer tree is over the compressed x's, and every one of its
+// nodes keeps a 1D Fenwick tree over the (compressed) y's of just the points
+// that it covers. Each point is covered by O(lgn) nodes, so the memory is
+// O(nlgn) and the operations run in O(lg^2n).
+//
+// All the inner trees live in a single flat array (the one of node i being
+// tree[offsets[i], offsets[i + 1])), alongside their sorted y's.
+template <typename T, typename Coord = int>
+class CompressedFenwick2D {
+ public:
+  // points are all the positions add() will ever be called on. If weights are
+  // given, point i starts out with weights[i] (which is much faster than
+  // calling add() for every point), otherwise everything starts at 0.
+  CompressedFenwick2D(const std::vector<std::pair<Coord, Coord>>& points,
+                      const std::vector<T>& weights = {}) {
+    xs.reserve(points.size());
+    for (const auto& point : points)
+      xs.push_back(point.first);
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    const int n = xs.size();
+
+    // Bucket the (y, weight) of every point into all the nodes covering it,
+    // i.e. the nodes that add() would touch. The points get processed in the
+    // order of their y's, so that the buckets end up sorted.
+    auto xIdx = std::vector<int>(points.size());
+    auto order = std::vector<std::pair<Coord, int>>(points.size());
+    for (int p = 0; p < points.size(); ++p) {
+      xIdx[p] = xIndex(points[p].first);
+      order[p] = {points[p].second, p};
+    }
+    std::sort(order.begin(), order.end());
+    offsets.assign(n + 2, 0);
+    for (const int xi : xIdx) {
+      for (int i = xi; i <= n; i += lsb(i))
+        ++offsets[i + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    ys.resize(offsets[n + 1]);
+    tree.resize(offsets[n + 1]);
+    auto pos = offsets;
+    for (const auto& [y, p] : order) {
+      const T weight = weights.empty() ? T(0) : weights[p];
+      for (int i = xIdx[p]; i <= n; i += lsb(i)) {
+        ys[pos[i]] = y;
+        tree[pos[i]++] = weight;
+      }
+    }
+
+    // Merge the duplicate y's of each node (moving the nodes to the left to
+    // close the gaps) and build the inner trees in linear time.
+    int out = 0;
+    for (int i = 1; i <= n; ++i) {
+      const int first = offsets[i], last = offsets[i + 1];
+      offsets[i] = out;
+      for (int j = first; j < last; ++j) {
+        if ((out > offsets[i]) && (ys[out - 1] == ys[j])) {
+          tree[out - 1] += tree[j];
+        } else {
+          ys[out] = ys[j];
+          tree[out++] = tree[j];
+        }
+      }
+      const int len = out - offsets[i];
+      T* node = tree.data() + offsets[i] - 1;  // 1-indexed.
+      for (int j = 1; j <= len; ++j) {
+        if (j + lsb(j) <= len)
+          node[j + lsb(j)] += node[j];
+      }
+    }
+    offsets[n + 1] = out;
+    ys.resize(out);
+    ys.shrink_to_fit();
+    tree.resize(out);
+    tree.shrink_to_fit();
+  }
+
+  // Adds k to the point (x, y).
+  // WARNING: (x, y) must be one of the points given to the constructor.
+  void add(Coord x, Coord y, T k) {
+    for (int i = xIndex(x); i < offsets.size() - 1; i += lsb(i)) {
+      const auto first = ys.begin() + offsets[i];
+      const int len = offsets[i + 1] - offsets[i];
+      T* node = tree.data() + offsets[i] - 1;
+      int j = std::lower_bound(first, first + len, y) - first + 1;
+      for (; j <= len; j += lsb(j))
+        node[j] += k;
+    }
+  }
+
+  // Returns the sum of the points in (-inf, x] x (-inf, y].
+  T sum(Coord x, Coord y) const {
+    return sumColumns(x, std::numeric_limits<Coord>::min(), y);
+  }
+
+  // Returns the sum of the points in the rectangle [x1, x2] x [y1, y2].
+  T sum(Coord x1, Coord y1, Coord x2, Coord y2) const {
+    return sumColumns(x2, y1, y2) - sumColumns(x1 - 1, y1, y2);
+  }
+
+ private:
+  // The sorted distinct x's.
+  std::vector<Coord> xs;
+  // The inner tree of (1-indexed) node i occupies [offsets[i], offsets[i + 1])
+  // of ys and tree.
+  std::vector<int> offsets;
+  std::vector<Coord> ys;
+  std::vector<T> tree;
+
+  // Returns the sum of the points in (-inf, x] x [y1, y2]. Both the y bounds
+  // get handled in a single pass over the outer tree.
+  T sumColumns(Coord x, Coord y1, Coord y2) const {
+    T res = 0;
+    int i = std::upper_bound(xs.begin(), xs.end(), x) - xs.begin();
+    for (; i > 0; i &= (i - 1)) {
+      const auto first = ys.begin() + offsets[i];
+      const auto last = ys.begin() + offsets[i + 1];
+      const T* node = tree.data() + offsets[i] - 1;
+      int hi = std::upper_bound(first, last, y2) - first;
+      int lo = std::lower_bound(first, first + hi, y1) - first;
+      // Walk both prefixes down until they meet (the shared part of the two
+      // paths cancels out).
+      while (hi != lo) {
+        if (hi > lo) {
+          res += node[hi];
+          hi &= (hi - 1);
+        } else {
+          res -= node[lo];
+          lo &= (lo - 1);
+        }
+      }
+    }
+    return res;
+  }
+
+  // The 1-indexed position of x among the xs.
+  int xIndex(Coord x) const {
+    return std::lower_bound(xs.begin(), xs.end(), x) - xs.begin() + 1;
+  }
+};
+
+// Hints the CPU to start loading the cache line containing p.
+inline void prefetch(const void* p) {
+#ifdef __GNUC__
+  __builtin_prefetch(p);
+#endif
+}
+
+// Same as Fenwick, but tuned for lowerBound (e.g. k-th element queries) on
+// large trees, where every step of the descent is a cache miss:
+//  - The descent is branchless and prefetches both candidates for the next
+//    level while the current one is still being loaded.
+//  - The array has a hole after every 2^holeBits entries (node k lives at
+//    k + (k >> holeBits)). Otherwise the nodes visited by a descent are (large
+//    powers of two) apart, so they all map to the same few cache sets and keep
+//    evicting each other.
+//  - lowerBound(targets) interleaves several searches, so that their cache
+//    misses overlap.
+//
+// Note: for trees that fit into the cache (~10^5 elements), the single-target
+// lowerBound is slower than the one of Fenwick, whose branches let the CPU
+// speculate ahead. The batched one is faster at all sizes.
+//
+// Note: the tree is 0-indexed and prefix sums are inclusive.
+//
+// All operations (except for the construction, which is O(n)) run in O(lgn).
+template <typename T>
+class PaddedFenwick {
+ public:
+  PaddedFenwick(int noElements) { reset(noElements); }
+
+  PaddedFenwick(const std::vector<T>& vec) { rebuild(vec); }
+
+  // Resets the tree to noElements zeros, reusing the existing storage.
+  void reset(int noElements) {
+    size = noElements + 1;
+    lastPower = msb(size);
+    tree.assign(pos(2 * lastPower) + 1, 0);
+  }
+
+  // Same as reset, except the tree gets filled with the entries of vec in O(n)
+  // time.
+  void rebuild(const std::vector<T>& vec) {
+    reset(vec.size());
+    for (int i = 0; i < vec.size(); ++i)
+      tree[pos(i + 1)] = vec[i];
+    for (int idx = 1; idx < 2 * lastPower; ++idx)
+      tree[pos(idx + lsb(idx))] += tree[pos(idx)];
+  }
+
+  // Returns the prefix sum of [0, idx] (0 for idx < 0).
+  T sum(int idx) const {
+    T res = 0;
+    for (++idx; idx > 0; idx &= (idx - 1))
+      res += tree[pos(idx)];
+    return res;
+  }
+
+  // Adds k to the element at index idx.
+  void add(int idx, T k) {
+    for (++idx; idx <= 2 * lastPower; idx += lsb(idx))
+      tree[pos(idx)] += k;
+  }
+
+  // Returns the first idx for which sum(idx) >= target (or size of the original
+  // vector if no such idx exists). WARNING: requires that all entries be >= 0.
+  int lowerBound(T target) const {
+    T acc = 0;
+    int idx = 0;
+    for (auto power = lastPower; power > 0; power >>= 1) {
+      prefetch(&tree[pos(idx + power / 2)]);
+      prefetch(&tree[pos(idx + power + power / 2)]);
+      // Multiplying by go (instead of ?:) keeps the compiler from branching.
+      const T val = tree[pos(idx + power)];
+      const bool go = acc + val < target;
+      idx += power * go;
+      acc += val * go;
+    }
+    return std::min(idx + 1, size) - 1;
+  }
+
+  // Batch version of lowerBound: res[k] == lowerBound(targets[k]). The searches
+  // run in groups of batchSize in lockstep, one level at a time, so a cache
+  // miss of one search gets overlapped with the work on the others.
+  std::vector<int> lowerBound(const std::vector<T>& targets) const {
+    constexpr int batchSize = 16;
+    auto res = std::vector<int>(targets.size());
+    for (int first = 0; first < targets.size(); first += batchSize) {
+      const int count = std::min<int>(batchSize, targets.size() - first);
+      std::array<int, batchSize> idx{};
+      std::array<T, batchSize> acc{};
+      for (auto power = lastPower; power > 0; power >>= 1) {
+        for (int j = 0; j < count; ++j) {
+          const T val = tree[pos(idx[j] + power)];
+          const bool go = acc[j] + val < targets[first + j];
+          idx[j] += power * go;
+          acc[j] += val * go;
+          // The next load of this search, which happens only after the loads
+          // of all the other searches in the group.
+          prefetch(&tree[pos(idx[j] + power / 2)]);
+        }
+      }
+      for (int j = 0; j < count; ++j)
+        res[first + j] = std::min(idx[j] + 1, size) - 1;
+    }
+    return res;
+  }
+
+ private:
+  static constexpr int holeBits = 10;
+
+  // Same as in Fenwick.
+  int size;
+  int lastPower;
+  // 1-indexed, node k is stored at pos(k).
+  std::vector<T> tree;
+
+  static int pos(const int k) { return k + (k >> holeBits); }
+};
+
+// Same as Fenwick, but over a huge index space [0, maxIndex] (e.g. keys up to
+// 10^18) of which only a few indices ever get touched. The nodes are stored in
+// a HashMap keyed by the (64-bit) internal index, and only the nodes on the
+// paths of add() calls ever get created, so the memory is O(adds * lgU) where
+// U is the size of the index space. Missing nodes are zeros. E.g. 10^6 random
+// adds over [0, 10^18] create about 2 * 10^7 nodes, which take about 1.1GB
+// with i64 values (HashMap's load factor is at most 1/2).
+//
+// All operations run in O(lgU) hash lookups, so expect a constant factor of
+// several times that of Fenwick. If all the keys are known in advance,
+// compressing them and using Fenwick is much faster and smaller.
+//
+// Note: requires HashMap.cpp.
+template <typename T>
+class SparseFenwick {
+ public:
+  // expectedAdds is only a hint for preallocating the hash map (an add()
+  // creates about lgU / 3 new nodes on average, once the top of the tree is
+  // filled in).
+  SparseFenwick(i64 maxIndex, int expectedAdds = 0)
+      : size(maxIndex + 2), lastPower(msb(size)) {
+    int levels = 0;
+    while ((i64(1) << levels) <= 2 * lastPower)
+      ++levels;
+    tree.reserve(int(std::min<i64>(i64(expectedAdds) * levels / 3, 1 << 28)));
+  }
+
+  // Returns the prefix sum of [0, idx] (0 for idx < 0).
+  T sum(i64 idx) const {
+    T res = 0;
+    for (++idx; idx > 0; idx &= (idx - 1)) {
+      if (const T* node = tree.find(idx))
+        res += *node;
+    }
+    return res;
+  }
+
+  // Adds k to the element at index idx.
+  void add(i64 idx, T k) {
+    for (++idx; idx <= 2 * lastPower; idx += lsb(idx))
+      tree[idx] += k;
+  }
+
+  // Returns the first idx for which sum(idx) >= target (or maxIndex + 1 if no
+  // such idx exists). WARNING: requires that all entries be >= 0.
+  i64 lowerBound(T target) const {
+    T acc = 0;
+    i64 idx = 0;
+    for (auto power = lastPower; power > 0; power >>= 1) {
+      const T* node = tree.find(idx | power);
+      const T val = node ? *node : T(0);
+      if (acc + val < target) {
+        acc += val;
+        idx |= power;
+      }
+    }
+    return std::min(idx + 1, size) - 1;
+  }
+
+  // The number of nodes stored.
+  int nodeCount() const { return tree.size(); }
+
+ private:
+  // Same as in Fenwick (the size of the index space + 1).
+  i64 size;
+  i64 lastPower;
+  HashMap<i64, T> tree;
 };
\ No newline at end of file
@@ -1,10 +1,13 @@
+// Note: the functions below take the graph as a template parameter, so they
+// work both with std::vector<std::vector<int>> and CsrGraph (see Template.cpp).
+
 // ------------------------------------------------------------
 // Reverse adjacency list stuff.
 // ------------------------------------------------------------
 
 // Returns the reverse adjacency list of a graph.
-std::vector<std::vector<int>> getReverseAdj(
-    const std::vector<std::vector<int>>& adj) {
+template <typename Graph>
+std::vector<std::vector<int>> getReverseAdj(const Graph& adj) {
   auto res = std::vector<std::vector<int>>(adj.size());
   for (int i = 0; i < adj.size(); ++i) {
     for (auto j : adj[i])
@@ -13,14 +16,29 @@ std::vector<std::vector<int>> getReverseAdj(
   return res;
 }
 
+// Same as above, but keeps the graph in the CSR format.
+CsrGraph<int> getReverseAdj(const CsrGraph<int>& adj) {
+  std::vector<int> from, to;
+  from.reserve(adj.edgeCount());
+  to.reserve(adj.edgeCount());
+  for (int i = 0; i < adj.size(); ++i) {
+    for (auto j : adj[i]) {
+      from.push_back(j);
+      to.push_back(i);
+    }
+  }
+  return CsrGraph<int>(adj.size(), from, to);
+}
+
 // ------------------------------------------------------------
 // Topological sort stuff.
 // ------------------------------------------------------------
 
-std::vector<int> inDegrees(const std::vector<std::vector<int>>& adj) {
+template <typename Graph>
+std::vector<int> inDegrees(const Graph& adj) {
   auto res = std::vector<int>(adj.size());
-  for (const auto& v : adj) {
-    for (auto i : v)
+  for (int u = 0; u < adj.size(); ++u) {
+    for (auto i : adj[u])
       ++res[i];
   }
   return res;
@@ -29,8 +47,8 @@ std::vector<int> inDegrees(const std::vector<std::vector<int>>& adj) {
 // Sorts the input dag topologically.
 // Returns a list of vertices in a topological order (or nothing, if input graph
 // isn't a dag).
-std::optional<std::vector<int>> topologicalSort(
-    const std::vector<std::vector<int>>& adj) {
+template <typename Graph>
+std::optional<std::vector<int>> topologicalSort(const Graph& adj) {
   auto degs = inDegrees(adj);
   std::queue<int> degZero;
   for (int i = 0; i < degs.size(); ++i) {
@@ -64,8 +82,9 @@ std::optional<std::vector<int>> topologicalSort(
 // Returns the indegrees of all vertices i where reps[i] == i (see the
 // topologicalSort function below). The first element of the pair is the number
 // of vertices in the graph (i.e. number of i's for which reps[i] == i).
-std::pair<int, std::vector<int>> getInDegrees(
-    const std::vector<std::vector<int>>& adj, const std::vector<int>& reps) {
+template <typename Graph>
+std::pair<int, std::vector<int>> getInDegrees(const Graph& adj,
+                                              const std::vector<int>& reps) {
   int count = 0;
   auto res = std::vector<int>(adj.size());
 
@@ -103,8 +122,9 @@ std::queue<int> getDegZero(const std::vector<int>& inDegrees,
 //
 // For an example, see
 // https://leetcode.com/problems/sort-items-by-groups-respecting-dependencies
-std::optional<std::vector<int>> topologicalSort(
-    const std::vector<std::vector<int>>& adj, const std::vector<int>& reps) {
+template <typename Graph>
+std::optional<std::vector<int>> topologicalSort(const Graph& adj,
+                                                const std::vector<int>& reps) {
   auto [noVertices, inDegrees] = getInDegrees(adj, reps);
   auto degZero = getDegZero(inDegrees, reps);
 
@@ -129,10 +149,7 @@ std::optional<std::vector<int>> topologicalSort(
 // Dijkstra stuff.
 // ------------------------------------------------------------
 
-struct Neighbor {
-  int id;
-  int w;
-};
+using Neighbor = WeightedEdge<>;
 
 struct NodeDist {
   int v;
@@ -143,7 +160,9 @@ bool operator<(const NodeDist& nd1, const NodeDist& nd2) {
   return nd1.d > nd2.d;
 }
 
-int64_t dijkstra(const std::vector<std::vector<Neighbor>>& adj, int s, int t) {
+template <typename Graph>
+int64_t dijkstra(const Graph& adj, int s, int t) {
+  PROF_SCOPE("dijkstra");
   auto dists = std::vector<int64_t>(adj.size(), -1);
   dists[s] = 0;
   auto flags = std::vector<bool>(adj.size(), false);
@@ -152,23 +171,28 @@ int64_t dijkstra(const std::vector<std::vector<Neighbor>>& adj, int s, int t) {
   while (!q.empty()) {
     const auto nd = q.top();
     q.pop();
+    PROF_COUNT("dijkstra::pop");
     if (nd.v == t)
       return dists[t];
-    if (flags[nd.v])
+    if (flags[nd.v]) {
+      PROF_COUNT("dijkstra::stalePop");
       continue;
+    }
     flags[nd.v] = true;
     for (auto neigh : adj[nd.v]) {
       if ((dists[neigh.id] < 0) || (dists[nd.v] + neigh.w < dists[neigh.id])) {
         dists[neigh.id] = dists[nd.v] + neigh.w;
         q.push(NodeDist{neigh.id, dists[neigh.id]});
+        PROF_COUNT("dijkstra::push");
       }
     }
   }
   return dists[t];
 }
 
-std::vector<int64_t> dijkstra(const std::vector<std::vector<Neighbor>>& adj,
-                              int s) {
+template <typename Graph>
+std::vector<int64_t> dijkstra(const Graph& adj, int s) {
+  PROF_SCOPE("dijkstra");
   auto dists = std::vector<int64_t>(adj.size(), -1);
   dists[s] = 0;
   auto flags = std::vector<bool>(adj.size(), false);
@@ -177,21 +201,25 @@ std::vector<int64_t> dijkstra(const std::vector<std::vector<Neighbor>>& adj,
   while (!q.empty()) {
     auto nd = q.top();
     q.pop();
-    if (flags[nd.v])
+    PROF_COUNT("dijkstra::pop");
+    if (flags[nd.v]) {
+      PROF_COUNT("dijkstra::stalePop");
       continue;
+    }
     flags[nd.v] = true;
     for (auto neigh : adj[nd.v]) {
       if ((dists[neigh.id] < 0) || (dists[nd.v] + neigh.w < dists[neigh.id])) {
         dists[neigh.id] = dists[nd.v] + neigh.w;
         q.push(NodeDist{neigh.id, dists[neigh.id]});
+        PROF_COUNT("dijkstra::push");
       }
     }
   }
   return dists;
 }
 
-std::vector<std::vector<int64_t>> dijkstra_apsp(
-    const std::vector<std::vector<Neighbor>>& adj) {
+template <typename Graph>
+std::vector<std::vector<int64_t>> dijkstra_apsp(const Graph& adj) {
   std::vector<std::vector<int64_t>> res;
   res.reserve(adj.size());
   for (int s = 0; s < adj.size(); ++s)
@@ -204,7 +232,8 @@ std::vector<std::vector<int64_t>> dijkstra_apsp(
 // ------------------------------------------------------------
 
 // Checks whether the (undirected) graph given by adj is bipartite.
-bool isBipartite(const std::vector<std::vector<int>>& adj) {
+template <typename Graph>
+bool isBipartite(const Graph& adj) {
   enum class Color { red, blue, none };
   auto colors = std::vector<Color>(adj.size(), Color::none);
   auto bfs = [&](int i) -> bool {
@@ -274,12 +303,42 @@ std::optional<std::vector<std::vector<int>>> floydWarshall(
   return prev;
 }
 
+// Same as above, except works in place on a flat Matrix, so the O(n^3) loop
+// runs over contiguous memory (and gets vectorized by the compiler).
+std::optional<Matrix<int>> floydWarshall(Matrix<int> weightMatrix) {
+  const int n = weightMatrix.rows();
+  for (int i = 0; i < n; ++i)
+    weightMatrix(i, i) = 0;
+
+  for (int k = 0; k < n; ++k) {
+    const int* rowK = weightMatrix[k];
+    for (int i = 0; i < n; ++i) {
+      int* rowI = weightMatrix[i];
+      const int ik = rowI[k];
+      if (ik == POS_INF<int>)
+        continue;
+      for (int j = 0; j < n; ++j) {
+        const int viaK =
+            (rowK[j] == POS_INF<int>) ? POS_INF<int> : ik + rowK[j];
+        rowI[j] = std::min(rowI[j], viaK);
+      }
+    }
+  }
+
+  for (int i = 0; i < n; ++i) {
+    if (weightMatrix(i, i) < 0)
+      return std::nullopt;
+  }
+  return weightMatrix;
+}
+
 // ------------------------------------------------------------
 // SCC Stuff.
 // ------------------------------------------------------------
 
-void sccsForwardDfs(const std::vector<std::vector<int>>& adj,
-                    std::vector<bool>& visited, std::stack<int>& ord, int u) {
+template <typename Graph>
+void sccsForwardDfs(const Graph& adj, std::vector<bool>& visited,
+                    std::stack<int>& ord, int u) {
   visited[u] = true;
   for (auto i : adj[u]) {
     if (visited[i])
@@ -289,8 +348,8 @@ void sccsForwardDfs(const std::vector<std::vector<int>>& adj,
   ord.push(u);
 }
 
-void sccsBackwardDfs(const std::vector<std::vector<int>>& adj,
-                     std::vector<int>& who, int rep, int u) {
+template <typename Graph>
+void sccsBackwardDfs(const Graph& adj, std::vector<int>& who, int rep, int u) {
   who[u] = rep;
   for (auto i : adj[u]) {
     if (who[i] >= 0)
@@ -300,8 +359,9 @@ void sccsBackwardDfs(const std::vector<std::vector<int>>& adj,
 }
 
 // Kosaraju's Algorithm.
+template <typename Graph>
 std::pair<std::vector<int>, std::vector<int>> stronglyConnectedComponents(
-    const std::vector<std::vector<int>>& adj) {
+    const Graph& adj) {
   std::stack<int> order;
   auto visited = std::vector<bool>(adj.size(), false);
   for (int i = 0; i < adj.size(); ++i) {
@@ -363,6 +423,8 @@ struct EulerTourData {
   struct TourVisit {
     int vertex;
     int depth;
+
+    bool operator==(const TourVisit&) const = default;
   };
 
   std::vector<TourVisit> eulerTour;
@@ -380,8 +442,8 @@ struct EulerTourData {
 // Performs an Euler Tour on (what is assummed to be) a tree with a given root.
 //
 // For example, see Codeforces Task 1467E--Distinctive Roots in a Tree
-EulerTourData eulerTour(const std::vector<std::vector<int>>& adj,
-                        const int root = 0) {
+template <typename Graph>
+EulerTourData eulerTour(const Graph& adj, const int root = 0) {
   auto res = EulerTourData(adj.size());
 
   auto tour =
@@ -411,17 +473,20 @@ EulerTourData eulerTour(const std::vector<std::vector<int>>& adj,
 // LCA queries in O(1) stuff.
 // ------------------------------------------------------------
 
-// Supports O(1) LCA queries on a tree. (With O(nlogn) precomputation time.)\
+// Supports O(1) LCA queries on a tree. (With O(n) precomputation time and
+// memory, see LinearRMQ in RMQ.cpp.)
 //
 // For example, see Codeforces 191C--Fools and Roads
 class LCA {
  public:
-  LCA(const std::vector<std::vector<int>>& adj, EulerTourData tourData)
+  template <typename Graph>
+  LCA(const Graph& adj, EulerTourData tourData)
       : rmq(tourVisitMin), tour(std::move(tourData)) {
     rmq.construct(tour.eulerTour);
   }
 
-  LCA(const std::vector<std::vector<int>>& adj, int root = 0)
+  template <typename Graph>
+  LCA(const Graph& adj, int root = 0)
       : LCA(adj, eulerTour(adj, root)) {}
 
   // Returns the lowest common ancestor of nodes u and v.
@@ -452,7 +517,7 @@ class LCA {
   bool inGraph(int u) const { return (u >= 0) && (u < tour.firstVisit.size()); }
 
   EulerTourData tour;
-  RMQ<TourVisit, decltype(tourVisitMin)> rmq;
+  LinearRMQ<TourVisit, decltype(tourVisitMin)> rmq;
 };
 
 // ------------------------------------------------------------
@@ -496,11 +561,11 @@ std::vector<int> eulerCycle(std::vector<std::unordered_set<int>> adj,
 //	- Leetcode 753. Cracking the Safe
 // https://leetcode.com/problems/cracking-the-safe/
 //	- CSES 1691--Mail Delivery https://cses.fi/problemset/task/1691/
-std::vector<int> eulerCycle(const std::vector<std::vector<int>>& adj,
-                            bool directed) {
+template <typename Graph>
+std::vector<int> eulerCycle(const Graph& adj, bool directed) {
   auto asSet = std::vector<std::unordered_set<int>>();
-  for (const auto& v : adj)
-    asSet.emplace_back(v.cbegin(), v.cend());
+  for (int u = 0; u < adj.size(); ++u)
+    asSet.emplace_back(adj[u].begin(), adj[u].end());
   return eulerCycle(std::move(asSet), directed);
 }
 
@@ -511,8 +576,8 @@ std::vector<int> eulerCycle(const std::vector<std::vector<int>>& adj,
 // Returns all bridges in the graph.
 //
 // For an example, see Codeforces Task 118E--Bertown Roads
-std::vector<std::pair<int, int>> getBridges(
-    const std::vector<std::vector<int>>& adj) {
+template <typename Graph>
+std::vector<std::pair<int, int>> getBridges(const Graph& adj) {
   auto arrival = std::vector<int>(adj.size(), -1);
   auto low = std::vector<int>(adj.size(), -1);
   int curTime = 0;
@@ -546,11 +611,11 @@ std::vector<std::pair<int, int>> getBridges(
 // Find cut vertices stuff.
 // ------------------------------------------------------------
 
-// Returns all cut vertices in the graph
-/
-    // For an example use, see https://www.spoj.com/problems/SUBMERGE/
-    std::unordered_set<int> getCutVertices(
-        const std::vector<std::vector<int>>& adj) {
+// Returns all cut vertices in the graph.
+//
+// For an example use, see https://www.spoj.com/problems/SUBMERGE/
+template <typename Graph>
+std::unordered_set<int> getCutVertices(const Graph& adj) {
   auto arrival = std::vector<int>(adj.size(), -1);
   auto low = std::vector<int>(adj.size(), -1);
   int curTime = 0;
@@ -589,9 +654,9 @@ std::vector<std::pair<int, int>> getBridges(
 // writing this).
 // ------------------------------------------------------------
 
+template <typename Graph>
 std::optional<std::pair<int, int>> getCycle_recursive(
-    const std::vector<std::vector<int>>& adj, int cur,
-    std::vector<int>& parent) {
+    const Graph& adj, int cur, std::vector<int>& parent) {
   for (auto i : adj[cur]) {
     if (i == parent[cur])
       continue;
@@ -608,8 +673,8 @@ std::optional<std::pair<int, int>> getCycle_recursive(
 // if no cycles exist).
 //
 // Note: doesn't work for directed graphs.
-std::optional<std::vector<int>> getCycle(
-    const std::vector<std::vector<int>>& adj) {
+template <typename Graph>
+std::optional<std::vector<int>> getCycle(const Graph& adj) {
   auto parent = std::vector<int>(adj.size(), -1);
   std::optional<std::pair<int, int>> endpoints;
   for (int i = 0; i < adj.size(); ++i) {
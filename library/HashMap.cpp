@@ -0,0 +1,202 @@
+// Picks the hasher used by HashMap/HashSet by default: custom_hash for integer
+// keys and pair_hash for pairs (both defined in Template.cpp).
+template <typename Key>
+struct DefaultHash {
+  using Type = custom_hash;
+};
+
+template <typename T, typename U>
+struct DefaultHash<std::pair<T, U>> {
+  using Type = pair_hash;
+};
+
+// Hash map with open addressing (linear probing) over a flat array of slots.
+// Unlike std::unordered_map, there is no allocation per element and lookups
+// touch one or two cache lines, so it's several times faster.
+//
+// The capacity is always a power of two and the load factor is kept <= 1/2.
+// Erasing uses backward shift deletion, so there are no tombstones and lookups
+// don't degrade after many erasures.
+//
+// Note: a pointer returned by find() (or a reference returned by operator[])
+// gets invalidated by any subsequent insertion or erasure.
+//
+// For an example, see UnionFindHash.cpp.
+template <typename Key, typename Value,
+          typename Hash = typename DefaultHash<Key>::Type>
+class HashMap {
+ public:
+  HashMap() = default;
+
+  explicit HashMap(const int expectedSize) { reserve(expectedSize); }
+
+  // Makes sure that n elements can be stored without rehashing.
+  //
+  // Note: the capacity is an int, so at most 2^29 elements fit (at load factor
+  // 1/2) and larger n get capped to that.
+  void reserve(const int n) {
+    const i64 target = 2 * i64(std::min(n, 1 << 29));
+    int cap = 8;
+    while (cap < target)
+      cap *= 2;
+    if (cap > capacity())
+      rehash(cap);
+  }
+
+  int size() const { return elementCount; }
+  bool empty() const { return elementCount == 0; }
+
+  // Removes all the elements, but keeps the allocated memory.
+  void clear() {
+    std::fill(used.begin(), used.end(), false);
+    elementCount = 0;
+  }
+
+  // Returns a pointer to the value stored under key (or nullptr if there isn't
+  // one).
+  Value* find(const Key& key) {
+    if (elementCount == 0)
+      return nullptr;
+    for (int i = home(key);; i = (i + 1) & mask) {
+      if (!used[i])
+        return nullptr;
+      if (slots[i].first == key)
+        return &slots[i].second;
+    }
+  }
+  const Value* find(const Key& key) const {
+    return const_cast<HashMap*>(this)->find(key);
+  }
+
+  int count(const Key& key) const { return find(key) != nullptr; }
+
+  // Inserts (key, val) if key is not present yet. Returns whether the
+  // insertion took place.
+  bool insert(const Key& key, const Value& val) {
+    const auto [idx, inserted] = findOrInsert(key);
+    if (inserted)
+      slots[idx].second = val;
+    return inserted;
+  }
+
+  Value& operator[](const Key& key) {
+    return slots[findOrInsert(key).first].second;
+  }
+
+  // Erases key from the map. Returns whether it was present.
+  bool erase(const Key& key) {
+    if (elementCount == 0)
+      return false;
+    int i = home(key);
+    for (;; i = (i + 1) & mask) {
+      if (!used[i])
+        return false;
+      if (slots[i].first == key)
+        break;
+    }
+
+    // Backward shift deletion: move the following elements of the cluster
+    // into the hole, as long as that doesn't put them before their home slot.
+    for (int j = (i + 1) & mask; used[j]; j = (j + 1) & mask) {
+      const int h = home(slots[j].first);
+      if (((j - h) & mask) >= ((j - i) & mask)) {
+        slots[i] = std::move(slots[j]);
+        i = j;
+      }
+    }
+    used[i] = false;
+    --elementCount;
+    return true;
+  }
+
+  // Calls f(key, value) for every element stored in the map (in no particular
+  // order).
+  template <typename Func>
+  void forEach(const Func& f) {
+    for (int i = 0; i < capacity(); ++i) {
+      if (used[i])
+        f(slots[i].first, slots[i].second);
+    }
+  }
+
+ private:
+  std::vector<std::pair<Key, Value>> slots;
+  std::vector<char> used;
+  int elementCount = 0;
+  int mask = -1;
+
+  int capacity() const { return slots.size(); }
+
+  int home(const Key& key) const { return Hash{}(key) & mask; }
+
+  // Returns {slot index of key, whether key had to be inserted}. Only grows
+  // the table if key is actually inserted, so looking up existing keys through
+  // operator[] never rehashes.
+  std::pair<int, bool> findOrInsert(const Key& key) {
+    int i = 0;
+    if (capacity() > 0) {
+      for (i = home(key); used[i]; i = (i + 1) & mask) {
+        if (slots[i].first == key)
+          return {i, false};
+      }
+    }
+    if (2 * (elementCount + 1) > capacity()) {
+      rehash(std::max(8, 2 * capacity()));
+      i = home(key);
+      while (used[i])
+        i = (i + 1) & mask;
+    }
+    used[i] = true;
+    slots[i].first = key;
+    slots[i].second = Value();
+    ++elementCount;
+    return {i, true};
+  }
+
+  void rehash(const int newCapacity) {
+    auto oldSlots = std::move(slots);
+    auto oldUsed = std::move(used);
+    slots = std::vector<std::pair<Key, Value>>(newCapacity);
+    used = std::vector<char>(newCapacity, false);
+    mask = newCapacity - 1;
+    for (int i = 0; i < oldSlots.size(); ++i) {
+      if (!oldUsed[i])
+        continue;
+      int j = home(oldSlots[i].first);
+      while (used[j])
+        j = (j + 1) & mask;
+      used[j] = true;
+      slots[j] = std::move(oldSlots[i]);
+    }
+  }
+};
+
+// Hash set counterpart of HashMap, see the description there.
+template <typename Key, typename Hash = typename DefaultHash<Key>::Type>
+class HashSet {
+ public:
+  HashSet() = default;
+
+  explicit HashSet(const int expectedSize) : map(expectedSize) {}
+
+  void reserve(const int n) { map.reserve(n); }
+  int size() const { return map.size(); }
+  bool empty() const { return map.empty(); }
+  void clear() { map.clear(); }
+
+  int count(const Key& key) const { return map.count(key); }
+
+  // Returns whether key was inserted (i.e. it wasn't present before).
+  bool insert(const Key& key) { return map.insert(key, true); }
+
+  // Returns whether key was present.
+  bool erase(const Key& key) { return map.erase(key); }
+
+  template <typename Func>
+  void forEach(const Func& f) {
+    map.forEach([&](const Key& key, char) { f(key); });
+  }
+
+ private:
+  HashMap<Key, char, Hash> map;
+};
@@ -0,0 +1,117 @@
+// Solves independent test cases in parallel. Replaces the usual
+//   for (int _testCase = 0; _testCase < t; ++_testCase) { ... }
+// loop from Template.cpp: first all the test cases get read (in order, on the
+// calling thread), then they are solved on a work-stealing thread pool and
+// finally the outputs are written to std::cout in the input order.
+//
+// Only worth it for inputs with many heavy test cases, and only where the
+// judge actually gives us more than one core.
+//
+// The solution has to provide:
+//  - readCase() -> Input, which reads a single test case,
+//  - solve(const Input&) -> Output, which must not touch any shared mutable
+//    state (the calls happen concurrently),
+//  - printCase(std::ostream&, int caseIdx, const Output&), which formats the
+//    output of the case (caseIdx is 0-indexed). Each thread formats into its
+//    own buffer, so this runs concurrently, too.
+//
+// For example:
+//   runTestCasesParallel(t, [] { return readVec<int>(); }, solve, printCase);
+template <typename ReadFn, typename SolveFn, typename PrintFn>
+void runTestCasesParallel(
+    const int t, const ReadFn& readCase, const SolveFn& solve,
+    const PrintFn& printCase,
+    int threads = std::max(1u, std::thread::hardware_concurrency())) {
+  using Input = std::decay_t<decltype(readCase())>;
+
+  std::vector<Input> inputs;
+  inputs.reserve(t);
+  for (int i = 0; i < t; ++i)
+    inputs.push_back(readCase());
+
+  threads = std::max(1, std::min(threads, t));
+
+  // The work of each thread is a range of case indices [lo, hi). The owner
+  // takes cases from the front, an idle thread steals the back half of the
+  // range of some other thread.
+  struct alignas(64) WorkRange {
+    std::mutex m;
+    int lo, hi;
+  };
+  auto ranges = std::vector<WorkRange>(threads);
+  for (int i = 0; i < threads; ++i) {
+    ranges[i].lo = int(i64(t) * i / threads);
+    ranges[i].hi = int(i64(t) * (i + 1) / threads);
+  }
+
+  // Where the output of each case ended up: {thread, begin, end}.
+  struct OutputSpan {
+    int thread, begin, end;
+  };
+  auto spans = std::vector<OutputSpan>(t);
+  auto buffers = std::vector<std::string>(threads);
+
+  auto popOwn = [&](const int id) -> int {
+    std::lock_guard lock(ranges[id].m);
+    if (ranges[id].lo == ranges[id].hi)
+      return -1;
+    return ranges[id].lo++;
+  };
+  auto steal = [&](const int id) -> bool {
+    for (int k = 1; k < threads; ++k) {
+      auto& victim = ranges[(id + k) % threads];
+      std::scoped_lock lock(victim.m, ranges[id].m);
+      const int left = victim.hi - victim.lo;
+      if (left == 0)
+        continue;
+      const int taken = (left + 1) / 2;
+      ranges[id].lo = victim.hi - taken;
+      ranges[id].hi = victim.hi;
+      victim.hi -= taken;
+      return true;
+    }
+    return false;
+  };
+
+  auto work = [&](const int id) {
+    std::ostringstream os;
+    for (;;) {
+      const int idx = popOwn(id);
+      if (idx < 0) {
+        if (steal(id))
+          continue;
+        break;
+      }
+      const auto output = solve(inputs[idx]);
+      spans[idx].thread = id;
+      spans[idx].begin = os.tellp();
+      printCase(os, idx, output);
+      spans[idx].end = os.tellp();
+    }
+    buffers[id] = os.str();
+  };
+
+  std::vector<std::thread> pool;
+  for (int i = 1; i < threads; ++i)
+    pool.emplace_back(work, i);
+  work(0);
+  for (auto& th : pool)
+    th.join();
+
+  for (const auto& [thread, begin, end] : spans)
+    std::cout.write(buffers[thread].data() + begin, end - begin);
+}
+
+// Same as above, but prints the outputs in the Kickstart/Code Jam format,
+// i.e. "Case #x: " followed by the output and a newline.
+template <typename ReadFn, typename SolveFn>
+void runTestCasesParallel(
+    const int t, const ReadFn& readCase, const SolveFn& solve,
+    int threads = std::max(1u, std::thread::hardware_concurrency())) {
+  runTestCasesParallel(
+      t, readCase, solve,
+      [](std::ostream& os, const int caseIdx, const auto& output) {
+        os << "Case #" << caseIdx + 1 << ": " << output << '\n';
+      },
+      threads);
+}
@@ -37,18 +37,23 @@ class RMQ {
 
   // Automatically constructs the RMQ structure based on the sequence and the
   // operation given.
-  RMQ(std::vector<T> vec, BinaryIdempotentOp operation = MinWrapper<T>{})
+  RMQ(const std::vector<T>& vec,
+      BinaryIdempotentOp operation = MinWrapper<T>{})
       : RMQ(operation) {
-    construct(std::move(vec));
+    construct(vec);
   }
 
   // (Re-) constructs the sparse table corresponding to the sequence in vec.
-  void construct(std::vector<T> vec) {
+  // The rows of the previous table get reused, so reconstructing (e.g. once
+  // per test case) allocates only if vec is longer than any sequence before.
+  void construct(const std::vector<T>& vec) {
     fillLogs(vec.size() + 1);
-    mins = std::vector<std::vector<T>>(logs[vec.size()] + 1,
-                                       std::vector<T>(vec.size()));
-    mins[0] = std::move(vec);
-    for (int i = 1; i < mins.size(); ++i) {
+    const int levels = logs[vec.size()] + 1;
+    if (mins.size() < levels)
+      mins.resize(levels);
+    mins[0].assign(vec.begin(), vec.end());
+    for (int i = 1; i < levels; ++i) {
+      mins[i].resize(vec.size());
       for (int j = 0; j < mins[i].size(); ++j) {
         const int upper =
             std::min(int(mins[i].size()) - 1, j + ((int(1)) << (i - 1)));
@@ -78,4 +83,90 @@ class RMQ {
     for (int i = logs.size(); i <= n; ++i)
       logs.push_back(logs[i / 2] + 1);
   }
+};
+
+// Same as RMQ, but with O(n) precomputation and memory (instead of O(nlgn)),
+// and still O(1) queries. The sequence is split into blocks of 64:
+//  - Queries spanning several blocks are answered by the RMQ of the block
+//    "minimums" (which has only n / 64 entries) and the two in-block queries
+//    at the ends.
+//  - Within each block, masks[i] is the monotone stack (as a bitmask over the
+//    positions in the block) of the elements that are the "minimum" of
+//    [j, i] for some j, i.e. that are not beaten by any element after them up
+//    to i. The answer for [lo, hi] within a block is then the lowest bit of
+//    masks[hi] which is >= lo.
+//
+// Uses n * (sizeof(T) + 8) bytes plus the negligible block table, e.g. ~12n
+// bytes for ints, while RMQ needs 4n * lgn (~100n for n = 10^7).
+//
+// Note: the in-block stacks need the operation to select one of its arguments
+// (like min or max, but unlike e.g. gcd), and T to have operator== (to tell
+// which argument got selected).
+template <typename T = int, typename BinaryIdempotentOp = MinWrapper<T>>
+class LinearRMQ {
+ public:
+  // Creates an empty LinearRMQ structure.
+  LinearRMQ(BinaryIdempotentOp operation = MinWrapper<T>{})
+      : op(operation), blocks(operation) {}
+
+  // Automatically constructs the structure based on the sequence and the
+  // operation given.
+  LinearRMQ(const std::vector<T>& vec,
+            BinaryIdempotentOp operation = MinWrapper<T>{})
+      : LinearRMQ(operation) {
+    construct(vec);
+  }
+
+  // (Re-) constructs the structure for the sequence in vec in O(n) time.
+  void construct(const std::vector<T>& vec) {
+    vals.assign(vec.begin(), vec.end());
+    masks.resize(vals.size());
+    blockMins.clear();
+    for (int first = 0; first < vals.size(); first += blockSize) {
+      const int last = std::min<int>(first + blockSize, vals.size());
+      uint64_t stack = 0;
+      for (int i = first; i < last; ++i) {
+        // Pop everything that vals[i] beats (or ties with).
+        while (stack) {
+          const int top = first + std::bit_width(stack) - 1;
+          if (!(op(vals[top], vals[i]) == vals[i]))
+            break;
+          stack ^= uint64_t(1) << (top - first);
+        }
+        stack |= uint64_t(1) << (i - first);
+        masks[i] = stack;
+      }
+      blockMins.push_back(vals[first + std::countr_zero(masks[last - 1])]);
+    }
+    blocks.construct(blockMins);
+  }
+
+  // Returns the "minimum" value (according to the operation) in the range [lo,
+  // hi].
+  T getMin(const int lo, const int hi) const {
+    const int loBlock = lo / blockSize, hiBlock = hi / blockSize;
+    if (loBlock == hiBlock)
+      return vals[inBlockMin(lo, hi)];
+    T res = vals[inBlockMin(lo, loBlock * blockSize + blockSize - 1)];
+    if (loBlock + 1 < hiBlock)
+      res = op(res, blocks.getMin(loBlock + 1, hiBlock - 1));
+    return op(res, vals[inBlockMin(hiBlock * blockSize, hi)]);
+  }
+
+ private:
+  static constexpr int blockSize = 64;
+
+  BinaryIdempotentOp op;
+  std::vector<T> vals;
+  std::vector<uint64_t> masks;
+  // The "minimum" of each block, and the sparse table over those.
+  std::vector<T> blockMins;
+  RMQ<T, BinaryIdempotentOp> blocks;
+
+  // Returns the index of the "minimum" in [lo, hi], where lo and hi are in the
+  // same block.
+  int inBlockMin(const int lo, const int hi) const {
+    const uint64_t mask = masks[hi] & (~uint64_t(0) << (lo % blockSize));
+    return hi - hi % blockSize + std::countr_zero(mask);
+  }
 };
\ No newline at end of file
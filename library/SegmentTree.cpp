@@ -1,9 +1,47 @@
 // TODO: accumulateWhole function? As a shorthand for query(0, sz-1).
-// TODO: think about the exact axiomatic requirements on the predicate for the
-// search (lowerBound/upperBound) functions.
-// TODO: generally clean up lowerBound/upperBound.
-// TODO: implicit segment tree (change children from unique_ptr to a proxy with
-// overloaded -> and so on) => test on 1469F--Power Sockets.
+
+// Tags that can be used as the UpdateData of SegmentTree and FlatSegmentTree
+// when the tree doesn't need lazy propagation:
+//  -- NoUpdates: the tree is only queried (e.g. 380C--Sereja and Brackets),
+//  -- PointUpdates<U>: only pointUpdate(idx, u) is used, where u is a U (and
+//  Data += U must be defined).
+// The trees then compile without the pending update in every node and
+// without any pushing.
+struct NoUpdates {};
+
+template <typename U>
+struct PointUpdates {};
+
+// Tells the trees the type of the updates passed to them and whether they
+// need lazy propagation.
+template <typename UpdateData>
+struct UpdateTraits {
+  using Type = UpdateData;
+  static constexpr bool lazy = true;
+};
+
+template <>
+struct UpdateTraits<NoUpdates> {
+  using Type = NoUpdates;
+  static constexpr bool lazy = false;
+};
+
+template <typename U>
+struct UpdateTraits<PointUpdates<U>> {
+  using Type = U;
+  static constexpr bool lazy = false;
+};
+
+// The pending update of a node, which is empty (and takes no space as a
+// [[no_unique_address]] member) for the trees without lazy propagation.
+template <typename Update, bool lazy = true>
+struct PendingUpdate {
+  Update upd;
+  bool set = false;
+};
+
+template <typename Update>
+struct PendingUpdate<Update, false> {};
 
 // Segment Tree with lazy propagation that allows range queries and range
 // updates in O(lgn) time.
@@ -15,6 +53,9 @@
 // Note: UpdateData also must have a default constructor. However, the
 // default-initialized value does not matter and can be arbitrary.
 //
+// Note: if there are no range updates, use NoUpdates or PointUpdates as the
+// UpdateData (see above), which makes the tree smaller and faster.
+//
 // For an example use, see
 //  -- Codeforces 380C--Sereja and Brackets (basic use, only queries and no
 //  updates)
@@ -31,18 +72,33 @@
 template <typename Data, typename UpdateData>
 class SegmentTree {
  public:
+  using Update = typename UpdateTraits<UpdateData>::Type;
+  static constexpr bool lazy = UpdateTraits<UpdateData>::lazy;
+
   // Constructs the segment tree on [0, sz) in O(nlgn) time, where init(i) is
   // the i-th entry in the range.
   //
   // WARNING: Cannot create an empty tree, i.e. we must have sz > 0.
   template <typename InitFn>
-  SegmentTree(const InitFn& init, const int sz) : root(init, 0, sz - 1) {}
+  SegmentTree(const InitFn& init, const int sz)
+      : sz(sz), root(init, 0, sz - 1) {}
+
+  // Re-initializes the tree to [0, sz) with the entries init(i), as if it were
+  // freshly constructed. The existing nodes get reused, so only the nodes the
+  // old tree did not have get allocated (e.g. none, if the new sz is at most
+  // the old one). Meant for inputs with many test cases.
+  template <typename InitFn>
+  void rebuild(const InitFn& init, const int sz) {
+    this->sz = sz;
+    root.rebuild(init, 0, sz - 1);
+  }
 
   // Accumulates the data in the range [lo, hi] in O(lgn) time.
   Data query(const int lo, const int hi) { return root.query(lo, hi); }
 
   // Lazily updates the range [lo, hi] in O(lgn) time.
-  void update(const int lo, const int hi, const UpdateData& upd) {
+  void update(const int lo, const int hi, const Update& upd) {
+    static_assert(lazy, "Range updates need lazy propagation.");
     root.update(lo, hi, upd);
   }
 
@@ -52,8 +108,8 @@ class SegmentTree {
 
   // Updates the entry at index idx.
   // Right now it doesn't do anything smarter than update(idx, idx, upd).
-  void pointUpdate(const int idx, const UpdateData& upd) {
-    update(idx, idx, upd);
+  void pointUpdate(const int idx, const Update& upd) {
+    root.update(idx, idx, upd);
   }
 
   // Same as query except only those parts of the range get accumulated, for
@@ -82,39 +138,63 @@ class SegmentTree {
   // Updates parts of the range [lo, hi] where pred(data) == 1 (and early exits
   // on pred(data) == -1). For a more detailed description, see query_if, the
   // pred function has the same effect here.
+  //
+  // Note: for clamping updates (a[i] = min(a[i], x) and the like), see
+  // SegmentTreeBeats.cpp, which has a complexity guarantee.
   template <typename UnaryPredicate>
-  void update_if(const int lo, const int hi, const UpdateData& upd,
+  void update_if(const int lo, const int hi, const Update& upd,
                  const UnaryPredicate& pred) {
+    static_assert(lazy, "Range updates need lazy propagation.");
     root.update_if(lo, hi, upd, pred);
   }
 
+  // Returns the first index hi >= lo such that !pred(query(lo, hi)), or the
+  // length of the stored array (that is, one past the last valid index) if
+  // there is no such index. Runs in O(lgn) time, without recursion.
+  //
+  // Note: pred must be a unary predicate on Data with pred(Data()) == true,
+  // which is monotone in the length of the interval, i.e. pred(query(lo, hi))
+  // implies pred(query(lo, hi - 1)). Data::operator+ doesn't have to be
+  // commutative, the data gets accumulated from left to right.
+  template <typename UnaryPredicate>
+  int maxRight(const int lo, const UnaryPredicate& pred) {
+    return root.maxRight(lo, pred);
+  }
+
+  // Mirror image of maxRight: returns the last index lo <= hi such that
+  // !pred(query(lo, hi)), or -1 if there is no such index. pred must satisfy
+  // the same requirements as for maxRight (with the interval now growing to
+  // the left). Runs in O(lgn) time, without recursion.
+  template <typename UnaryPredicate>
+  int minLeft(const int hi, const UnaryPredicate& pred) {
+    return root.minLeft(hi, pred);
+  }
+
   // Searches for the first index hi such that !pred(query(lo, hi), target).
   // If there is no such index, returns the length of the stored array (that is,
-  // one past the last valid index).
-  // Runs in O(lgn) time.
+  // one past the last valid index). If already !pred(Data(), target), returns
+  // lo - 1. Runs in O(lgn) time.
   //
   // Note: the function pred should be a binary predicate on Data (intuitively,
-  // a "<" operator) that must define a strict weak ordering that is
-  // monotonically increasing in interval length (so we must have
-  // pred(query(lo, hi), query(lo, hi + k)) for all lo <= hi and all k > 0).
-  //
-  // WARNING: May run slow, may TLE despite good asymptotic complexity.
+  // a "<" operator) that is monotone in interval length, i.e. we must have
+  // pred(query(lo, hi), target) => pred(query(lo, hi - 1), target). See
+  // maxRight.
   template <typename BinaryPredicate>
   int lowerBound(const int lo, const Data& target,
                  const BinaryPredicate& pred) {
-    auto [idx, acc] = root.lowerBound(lo, target, pred, Data());
-    return idx;
+    if (!pred(Data(), target))
+      return lo - 1;
+    return maxRight(lo, [&](const Data& acc) { return pred(acc, target); });
   }
 
   // Same as lowerBound except returns first index hi such that pred(target,
   // query(lo, hi)). See lowerBound for more data on the predicate.
-  //
-  // WARNING: May run pretty slow, may TLE despite good asymptotic complexity
   template <typename BinaryPredicate>
   int upperBound(const int lo, const Data& target,
                  const BinaryPredicate& pred) {
-    auto [idx, acc] = root.upperBound(lo, target, pred, Data());
-    return idx;
+    if (pred(target, Data()))
+      return lo - 1;
+    return maxRight(lo, [&](const Data& acc) { return !pred(target, acc); });
   }
 
   // Returns a vector containg all of the data stored in the tree (i.e. all the
@@ -127,6 +207,49 @@ class SegmentTree {
     return res;
   }
 
+  struct RangeUpdate {
+    int lo, hi;
+    Update upd;
+  };
+
+  // Applies all the updates (in the given order) in a single sweep over the
+  // tree: every node is visited (and pushed) at most once for any run of
+  // consecutive updates that only partially cover it, instead of once per
+  // update. An update that covers the whole node can only be applied after the
+  // preceding ones have been passed down, so it ends such a run.
+  //
+  // If the order of the updates doesn't matter (e.g. range additions), pass
+  // commutative = true: then all the updates covering a node get applied to it
+  // right away and the remaining ones are passed down in a single run. That's
+  // the mode worth batching for: on 10^6 random range additions it takes about
+  // 60% of the time of single update() calls, while the ordered mode (where
+  // the high nodes get split into many short runs) takes about 80%. For small
+  // trees (about 10^4 elements or less), batching doesn't pay off at all.
+  //
+  // The updates don't have to be sorted, but the sweep shares the most work
+  // if they are (e.g. sorted by lo), since neighbouring updates then visit the
+  // same nodes.
+  void applyBatch(const std::vector<RangeUpdate>& upds,
+                  const bool commutative = false) {
+    static_assert(lazy, "Range updates need lazy propagation.");
+    if (upds.empty())
+      return;
+    auto& scratch = prepareBatchScratch(upds.size());
+    root.applyBatch(upds, scratch, 0, commutative);
+  }
+
+  // Returns {query(lo, hi) for {lo, hi} in ranges} (in the same order),
+  // computed in a single sweep over the tree that visits and pushes every node
+  // at most once. See applyBatch.
+  std::vector<Data> queryBatch(const std::vector<std::pair<int, int>>& ranges) {
+    auto res = std::vector<Data>(ranges.size());
+    if (ranges.empty())
+      return res;
+    auto& scratch = prepareBatchScratch(ranges.size());
+    root.queryBatch(ranges, res, scratch, 0);
+    return res;
+  }
+
  private:
   class Node {
    public:
@@ -143,9 +266,35 @@ class SegmentTree {
       data = left->data + right->data;
     }
 
+    // Same as the constructor, except the existing children get reused. A
+    // node which becomes a leaf keeps its children around for later rebuilds
+    // (leaves are always recognized by leftmost == rightmost, never by the
+    // children missing).
+    template <typename InitFn>
+    void rebuild(const InitFn& init, const int lo, const int hi) {
+      leftmost = lo;
+      rightmost = hi;
+      if constexpr (lazy)
+        pending.set = false;
+      if (leftmost == rightmost) {
+        data = init(leftmost);
+        return;
+      }
+      auto mid = lo + (hi - lo) / 2;
+      if (left) {
+        left->rebuild(init, lo, mid);
+        right->rebuild(init, mid + 1, hi);
+      } else {
+        left = std::make_unique<Node>(init, lo, mid);
+        right = std::make_unique<Node>(init, mid + 1, hi);
+      }
+      data = left->data + right->data;
+    }
+
     // TODO: make this simply call query_if with a predicate which always
     // returns true? (It might make the constant factor of query() worse.)
     Data query(const int lo, const int hi) {
+      PROF_COUNT("SegmentTree::visit");
       if (isDisjoint(lo, hi))
         return Data();
       if (coversUs(lo, hi))
@@ -157,7 +306,8 @@ class SegmentTree {
     }
 
     // TODO: same as for query().
-    void update(const int lo, const int hi, const UpdateData& upd) {
+    void update(const int lo, const int hi, const Update& upd) {
+      PROF_COUNT("SegmentTree::visit");
       if (isDisjoint(lo, hi))
         return;
       if (coversUs(lo, hi)) {
@@ -172,6 +322,7 @@ class SegmentTree {
 
     template <typename UnaryPredicate>
     Data query_if(const int lo, const int hi, const UnaryPredicate& pred) {
+      PROF_COUNT("SegmentTree::visit");
       if (isDisjoint(lo, hi))
         return Data();
       if (coversUs(lo, hi)) {
@@ -191,8 +342,9 @@ class SegmentTree {
     }
 
     template <typename UnaryPredicate>
-    void update_if(const int lo, const int hi, const UpdateData& upd,
+    void update_if(const int lo, const int hi, const Update& upd,
                    const UnaryPredicate& pred) {
+      PROF_COUNT("SegmentTree::visit");
       if (isDisjoint(lo, hi))
         return;
       if (coversUs(lo, hi)) {
@@ -204,100 +356,101 @@ class SegmentTree {
           return;
         }
       }
+      if (leftmost == rightmost)  // If we are a leaf and get here, pred == 0.
+        return;
       push();
       left->update_if(lo, hi, upd, pred);
       right->update_if(lo, hi, upd, pred);
       data = left->data + right->data;
     }
 
-    // Return value is equal to {hi, acc}, where
-    //	hi = first index such that !pred(query(lo, hi), target), or rightmost +
-    //    1 if no such index exists;
-    //  acc = query(lo, hi) (if hi == rightmost + 1, then returns query(lo,
-    //    rightmost)).
-    //
-    // TODO: Update the comments above.
-    // TODO: Make sure this works correctly for non-commutative Data::operator+.
-    // TODO: Implement this with a Node* pointer so as to avoid constantly
-    // passing the references to target and pred.
-    template <typename BinaryPredicate>
-    std::pair<int, Data> lowerBound(const int lo, const Data& target,
-                                    const BinaryPredicate& pred,
-                                    const Data& curAcc) {
-      // We only consider sequences which begin somewhere in our interval (see
-      // the standard case below to understand why checking for this is
-      // convenient).
-      if ((lo < leftmost) || (rightmost < lo))
-        return {rightmost + 1, curAcc};
-
-      // We're already good enough (this case may pop up if the empty interval
-      // is good).
-      if (!pred(curAcc, target))
-        return {lo - 1, curAcc};
-
-      const auto totalAcc = curAcc + data;
-
-      // We are a leaf, return our index if we're good, our index + 1 if we
-      // aren't.
-      if (leftmost == rightmost)
-        return {rightmost + pred(totalAcc, target), totalAcc};
-
-      // Even our whole interval wouldn't be enough, so we can break early (here
-      // we need the monotonicity of pred, which is crucial for the logarithmic
-      // running time).
-      if ((lo == leftmost) && pred(totalAcc, target))
-        return {rightmost + 1, totalAcc};
-
-      // Standard case: first check if the index is in our left half, if not,
-      // check the right one.
-      push();
-      auto [leftIdx, leftAcc] = left->lowerBound(lo, target, pred, curAcc);
-      if (leftIdx <= left->rightmost)
-        return {leftIdx, leftAcc};
-
-      return right->lowerBound(std::max(lo, right->leftmost), target, pred,
-                               leftAcc);
-    }
-
-    // TODO: Improve the implementation to remove the duplication between
-    // lowerBound and upperBound.
-    template <typename BinaryPredicate>
-    std::pair<int, Data> upperBound(const int lo, const Data& target,
-                                    const BinaryPredicate& pred,
-                                    const Data& curAcc) {
-      // We only consider sequences which begin somewhere in our interval (see
-      // the standard case below to understand why checking for this is
-      // convenient).
-      if ((lo < leftmost) || (rightmost < lo))
-        return {rightmost + 1, curAcc};
-
-      // We're already good enough (this case may pop up if the empty interval
-      // is good).
-      if (pred(target, curAcc))
-        return {lo - 1, curAcc};
-
-      const auto totalAcc = curAcc + data;
-
-      // We are a leaf, return our index if we're good, our index+1 if we
-      // aren't.
-      if (leftmost == rightmost)
-        return {rightmost + !pred(target, totalAcc), totalAcc};
-
-      // Even our whole interval wouldn't be enough, so we can break early (here
-      // we need the monotonicity of pred, which is crucial for the logarithmic
-      // running time).
-      if ((lo == leftmost) && !pred(target, totalAcc))
-        return {rightmost + 1, totalAcc};
-
-      // Standard case: first check if the index is in our left half, if not,
-      // check the right one.
-      push();
-      auto [leftIdx, leftAcc] = left->upperBound(lo, target, pred, curAcc);
-      if (leftIdx <= left->rightmost)
-        return {leftIdx, leftAcc};
+    // The nodes covering [lo, rightmost] are the node with leftmost == lo
+    // reached by descending towards lo, and the right children passed on the
+    // way there. Those get checked from left to right, until the accumulated
+    // data fails pred, and then we descend into the failing node.
+    template <typename UnaryPredicate>
+    int maxRight(const int lo, const UnaryPredicate& pred) {
+      if (lo > rightmost)
+        return rightmost + 1;
+      std::array<Node*, maxDepth> cover;
+      int coverCount = 0;
+      Node* node = this;
+      while (node->leftmost != lo) {
+        node->push();
+        if (lo <= node->left->rightmost) {
+          cover[coverCount++] = node->right.get();
+          node = node->left.get();
+        } else {
+          node = node->right.get();
+        }
+      }
+      cover[coverCount++] = node;
 
-      return right->upperBound(std::max(lo, right->leftmost), target, pred,
-                               leftAcc);
+      Data acc;
+      for (int i = coverCount - 1; i >= 0; --i) {
+        node = cover[i];
+        auto next = acc + node->data;
+        if (pred(next)) {
+          acc = std::move(next);
+          continue;
+        }
+        while (node->leftmost != node->rightmost) {
+          PROF_COUNT("SegmentTree::visit");
+          node->push();
+          next = acc + node->left->data;
+          if (pred(next)) {
+            acc = std::move(next);
+            node = node->right.get();
+          } else {
+            node = node->left.get();
+          }
+        }
+        return node->leftmost;
+      }
+      return rightmost + 1;
+    }
+
+    // Mirror image of maxRight.
+    template <typename UnaryPredicate>
+    int minLeft(const int hi, const UnaryPredicate& pred) {
+      if (hi < leftmost)
+        return leftmost - 1;
+      std::array<Node*, maxDepth> cover;
+      int coverCount = 0;
+      Node* node = this;
+      while (node->rightmost != hi) {
+        node->push();
+        if (hi >= node->right->leftmost) {
+          cover[coverCount++] = node->left.get();
+          node = node->right.get();
+        } else {
+          node = node->left.get();
+        }
+      }
+      cover[coverCount++] = node;
+
+      Data acc;
+      for (int i = coverCount - 1; i >= 0; --i) {
+        node = cover[i];
+        auto next = node->data + acc;
+        if (pred(next)) {
+          acc = std::move(next);
+          continue;
+        }
+        while (node->leftmost != node->rightmost) {
+          PROF_COUNT("SegmentTree::visit");
+          node->push();
+          next = node->right->data + acc;
+          if (pred(next)) {
+            acc = std::move(next);
+            node = node->left.get();
+          } else {
+            node = node->right.get();
+          }
+        }
+        return node->rightmost;
+      }
+      return leftmost - 1;
     }
 
     void getContents(std::vector<Data>& res) {
@@ -310,15 +463,80 @@ class SegmentTree {
       right->getContents(res);
     }
 
+    // scratch[depth] holds the indices of the queries which intersect us. The
+    // deeper levels of scratch are used by the recursive calls.
+    void queryBatch(const std::vector<std::pair<int, int>>& ranges,
+                    std::vector<Data>& res,
+                    std::vector<std::vector<int>>& scratch, const int depth) {
+      PROF_COUNT("SegmentTree::visit");
+      auto& cur = scratch[depth];
+      int partial = 0;
+      for (const int i : cur) {
+        if (coversUs(ranges[i].first, ranges[i].second))
+          res[i] = res[i] + data;
+        else
+          cur[partial++] = i;
+      }
+      cur.resize(partial);
+      if (partial == 0)
+        return;
+      push();
+      // The left child goes first, so that the results get accumulated in
+      // order.
+      for (Node* child : {left.get(), right.get()}) {
+        auto& next = scratch[depth + 1];
+        next.clear();
+        for (const int i : cur) {
+          if (!child->isDisjoint(ranges[i].first, ranges[i].second))
+            next.push_back(i);
+        }
+        if (!next.empty())
+          child->queryBatch(ranges, res, scratch, depth + 1);
+      }
+    }
+
+    // scratch[depth] holds the indices of the updates which intersect us (in
+    // order).
+    template <typename RangeUpdate>
+    void applyBatch(const std::vector<RangeUpdate>& upds,
+                    std::vector<std::vector<int>>& scratch, const int depth,
+                    const bool commutative) {
+      PROF_COUNT("SegmentTree::visit");
+      auto& cur = scratch[depth];
+      if (commutative) {
+        int partial = 0;
+        for (const int i : cur) {
+          if (coversUs(upds[i].lo, upds[i].hi))
+            accumulateUpdate(upds[i].upd);
+          else
+            cur[partial++] = i;
+        }
+        if (partial > 0)
+          passDown(upds, scratch, depth, 0, partial, commutative);
+        return;
+      }
+
+      int runBegin = 0;
+      for (int j = 0; j <= int(cur.size()); ++j) {
+        if (j < cur.size() && !coversUs(upds[cur[j]].lo, upds[cur[j]].hi))
+          continue;
+        if (runBegin < j)
+          passDown(upds, scratch, depth, runBegin, j, commutative);
+        if (j < cur.size())
+          accumulateUpdate(upds[cur[j]].upd);
+        runBegin = j + 1;
+      }
+    }
+
    private:
-    // The ordering of members is probably quite cache-unfriendly (that random
-    // bool in the middle lol), but w/e, it's not like a pointer-based Segment
-    // Tree will be a speed demon.
-    const int leftmost, rightmost;
+    // The ordering of members is probably quite cache-unfriendly, but w/e,
+    // it's not like a pointer-based Segment Tree will be a speed demon.
+    static constexpr int maxDepth = 32;  // The depth of a tree with int sizes.
+
+    int leftmost, rightmost;
     std::unique_ptr<Node> left, right;
     Data data;
-    bool lazySet = false;
-    UpdateData lazyUpdate;
+    [[no_unique_address]] PendingUpdate<Update, lazy> pending;
 
     bool coversUs(const int lo, const int hi) {
       return (lo <= leftmost) && (rightmost <= hi);
@@ -330,25 +548,1245 @@ class SegmentTree {
 
     // Pushes our pending update onto our children.
     void push() {
-      if (!lazySet)
-        return;
-      left->accumulateUpdate(lazyUpdate);
-      right->accumulateUpdate(lazyUpdate);
-      lazySet = false;
+      if constexpr (lazy) {
+        if (!pending.set)
+          return;
+        PROF_COUNT("SegmentTree::push");
+        left->accumulateUpdate(pending.upd);
+        right->accumulateUpdate(pending.upd);
+        pending.set = false;
+      }
     }
 
-    // Updates our current node and the pending update.
-    void accumulateUpdate(const UpdateData& upd) {
+    // Updates our current node and the pending update. (Without lazy
+    // propagation, this only gets called on the leaves.)
+    void accumulateUpdate(const Update& upd) {
       data += upd;
-      if (lazySet)
-        lazyUpdate += upd;
-      else
-        lazyUpdate = upd;
-      lazySet = true;
+      if constexpr (lazy) {
+        if (pending.set)
+          pending.upd += upd;
+        else
+          pending.upd = upd;
+        pending.set = true;
+      }
+    }
+
+    // Passes the updates scratch[depth][runBegin..runEnd), none of which
+    // covers us, down to our children.
+    template <typename RangeUpdate>
+    void passDown(const std::vector<RangeUpdate>& upds,
+                  std::vector<std::vector<int>>& scratch, const int depth,
+                  const int runBegin, const int runEnd,
+                  const bool commutative) {
+      push();
+      if (runEnd - runBegin == 1) {
+        // A lone update is cheaper to apply directly than to sweep.
+        const auto& upd = upds[scratch[depth][runBegin]];
+        left->update(upd.lo, upd.hi, upd.upd);
+        right->update(upd.lo, upd.hi, upd.upd);
+        data = left->data + right->data;
+        return;
+      }
+      for (Node* child : {left.get(), right.get()}) {
+        auto& next = scratch[depth + 1];
+        next.clear();
+        for (int j = runBegin; j < runEnd; ++j) {
+          const auto& upd = upds[scratch[depth][j]];
+          if (!child->isDisjoint(upd.lo, upd.hi))
+            next.push_back(scratch[depth][j]);
+        }
+        if (!next.empty())
+          child->applyBatch(upds, scratch, depth + 1, commutative);
+      }
+      data = left->data + right->data;
     }
   };  // End struct Node
 
+  int sz;
   Node root;
+  // Per-depth lists of query/update indices used by queryBatch/applyBatch.
+  std::vector<std::vector<int>> batchScratch;
+
+  std::vector<std::vector<int>>& prepareBatchScratch(const int batchSize) {
+    int depth = 1;
+    while ((1 << (depth - 1)) < sz)
+      ++depth;
+    if (batchScratch.size() < depth + 1)
+      batchScratch.resize(depth + 1);
+    batchScratch[0].resize(batchSize);
+    std::iota(batchScratch[0].begin(), batchScratch[0].end(), 0);
+    return batchScratch;
+  }
+};
+
+// Same as SegmentTree (with the same requirements on Data and UpdateData),
+// except the nodes are stored in flat arrays (the children of node k are 2k
+// and 2k + 1) and queries/updates run bottom-up with loops instead of
+// recursion. On 10^6 elements (see benchSegmentTree in Benchmark.cpp) that
+// makes building about 8x, queries about 7x and lazy range updates only about
+// 2x faster than the pointer-based tree: an update still has to push and
+// recompute along both boundary paths.
+//
+// Supports construction, query/update, pointQuery/pointUpdate,
+// maxRight/minLeft, lowerBound/upperBound, applyBatch/queryBatch and
+// getContents, so it can replace SegmentTree whenever the query_if/update_if
+// functions are not needed. (The batch functions simply make single calls,
+// the bottom-up walks are cheap enough that a shared sweep doesn't pay off.)
+//
+// Note: the array sizes are rounded up to a power of two, the padding leaves
+// are initialized to Data().
+template <typename Data, typename UpdateData>
+class FlatSegmentTree {
+ public:
+  using Update = typename UpdateTraits<UpdateData>::Type;
+  static constexpr bool lazy = UpdateTraits<UpdateData>::lazy;
+
+  // Constructs the segment tree on [0, sz) in O(n) time, where init(i) is the
+  // i-th entry in the range.
+  template <typename InitFn>
+  FlatSegmentTree(const InitFn& init, const int sz) {
+    rebuild(init, sz);
+  }
+
+  // Re-initializes the tree to [0, sz) with the entries init(i), as if it were
+  // freshly constructed. Reuses the existing arrays, so nothing gets allocated
+  // unless the tree grows beyond its largest size so far.
+  template <typename InitFn>
+  void rebuild(const InitFn& init, const int sz) {
+    this->sz = sz;
+    log = 0;
+    while ((1 << log) < sz)
+      ++log;
+    size = 1 << log;
+    data.assign(2 * size, Data());
+    if constexpr (lazy) {
+      lazyUpdate.resize(size);
+      lazySet.assign(size, false);
+    }
+    for (int i = 0; i < sz; ++i)
+      data[size + i] = init(i);
+    for (int k = size - 1; k > 0; --k)
+      recompute(k);
+  }
+
+  // Accumulates the data in the range [lo, hi] in O(lgn) time.
+  Data query(const int lo, const int hi) {
+    int l = lo + size, r = hi + 1 + size;
+    pushBoundaries(l, r);
+
+    // Accumulate from both ends separately since + needn't be commutative.
+    Data leftAcc, rightAcc;
+    for (; l < r; l >>= 1, r >>= 1) {
+      if (l & 1)
+        leftAcc = leftAcc + data[l++];
+      if (r & 1)
+        rightAcc = data[--r] + rightAcc;
+    }
+    return leftAcc + rightAcc;
+  }
+
+  // Lazily updates the range [lo, hi] in O(lgn) time.
+  void update(const int lo, const int hi, const Update& upd) {
+    static_assert(lazy, "Range updates need lazy propagation.");
+    const int l0 = lo + size, r0 = hi + 1 + size;
+    pushBoundaries(l0, r0);
+
+    for (int l = l0, r = r0; l < r; l >>= 1, r >>= 1) {
+      if (l & 1)
+        accumulateUpdate(l++, upd);
+      if (r & 1)
+        accumulateUpdate(--r, upd);
+    }
+
+    for (int i = 1; i <= log; ++i) {
+      if (((l0 >> i) << i) != l0)
+        recompute(l0 >> i);
+      if (((r0 >> i) << i) != r0)
+        recompute((r0 - 1) >> i);
+    }
+  }
+
+  Data pointQuery(const int idx) {
+    const int leaf = idx + size;
+    for (int i = log; i > 0; --i)
+      push(leaf >> i);
+    return data[leaf];
+  }
+
+  void pointUpdate(const int idx, const Update& upd) {
+    const int leaf = idx + size;
+    for (int i = log; i > 0; --i)
+      push(leaf >> i);
+    data[leaf] += upd;
+    for (int i = 1; i <= log; ++i)
+      recompute(leaf >> i);
+  }
+
+  // See SegmentTree::maxRight.
+  template <typename UnaryPredicate>
+  int maxRight(const int lo, const UnaryPredicate& pred) {
+    if (lo == sz)
+      return sz;
+    int k = lo + size;
+    for (int i = log; i > 0; --i)
+      push(k >> i);
+
+    // Go up while k is a right child, since then [lo, ...) starts in the
+    // middle of its parent.
+    Data acc;
+    do {
+      while (k % 2 == 0)
+        k >>= 1;
+      auto next = acc + data[k];
+      if (!pred(next)) {
+        while (k < size) {
+          push(k);
+          k = 2 * k;
+          next = acc + data[k];
+          if (pred(next)) {
+            acc = std::move(next);
+            ++k;
+          }
+        }
+        return k - size;
+      }
+      acc = std::move(next);
+      ++k;
+    } while ((k & -k) != k);  // Stop once k wraps around to a power of two.
+    return sz;
+  }
+
+  // See SegmentTree::minLeft.
+  template <typename UnaryPredicate>
+  int minLeft(const int hi, const UnaryPredicate& pred) {
+    if (hi < 0)
+      return -1;
+    int k = hi + 1 + size;
+    for (int i = log; i > 0; --i)
+      push((k - 1) >> i);
+
+    Data acc;
+    do {
+      --k;
+      while (k > 1 && k % 2 == 1)
+        k >>= 1;
+      auto next = data[k] + acc;
+      if (!pred(next)) {
+        while (k < size) {
+          push(k);
+          k = 2 * k + 1;
+          next = data[k] + acc;
+          if (pred(next)) {
+            acc = std::move(next);
+            --k;
+          }
+        }
+        return k - size;
+      }
+      acc = std::move(next);
+    } while ((k & -k) != k);
+    return -1;
+  }
+
+  // See SegmentTree::lowerBound.
+  template <typename BinaryPredicate>
+  int lowerBound(const int lo, const Data& target,
+                 const BinaryPredicate& pred) {
+    if (!pred(Data(), target))
+      return lo - 1;
+    return maxRight(lo, [&](const Data& acc) { return pred(acc, target); });
+  }
+
+  // See SegmentTree::upperBound.
+  template <typename BinaryPredicate>
+  int upperBound(const int lo, const Data& target,
+                 const BinaryPredicate& pred) {
+    if (pred(target, Data()))
+      return lo - 1;
+    return maxRight(lo, [&](const Data& acc) { return !pred(target, acc); });
+  }
+
+  struct RangeUpdate {
+    int lo, hi;
+    Update upd;
+  };
+
+  // Same interface as SegmentTree::applyBatch, applies the updates one by one
+  // (in order, so commutative makes no difference).
+  void applyBatch(const std::vector<RangeUpdate>& upds,
+                  const bool commutative = false) {
+    for (const auto& [lo, hi, upd] : upds)
+      update(lo, hi, upd);
+  }
+
+  // Same as SegmentTree::queryBatch, answers the queries one by one.
+  std::vector<Data> queryBatch(const std::vector<std::pair<int, int>>& ranges) {
+    std::vector<Data> res;
+    res.reserve(ranges.size());
+    for (const auto& [lo, hi] : ranges)
+      res.push_back(query(lo, hi));
+    return res;
+  }
+
+  // Returns a vector containg all of the data stored in the tree (i.e. all the
+  // Data's in the leaves, in order). Runs in O(n) time.
+  std::vector<Data> getContents() {
+    for (int k = 1; k < size; ++k)
+      push(k);
+    return std::vector<Data>(data.begin() + size, data.begin() + size + sz);
+  }
+
+ private:
+  int sz, log = 0, size;
+  // data[1] is the root, data[size + i] is the i-th leaf.
+  std::vector<Data> data;
+  // Pending updates of the internal nodes (empty without lazy propagation).
+  std::vector<Update> lazyUpdate;
+  std::vector<char> lazySet;
+
+  void recompute(const int k) { data[k] = data[2 * k] + data[2 * k + 1]; }
+
+  void accumulateUpdate(const int k, const Update& upd) {
+    data[k] += upd;
+    if (k >= size)
+      return;
+    if (lazySet[k])
+      lazyUpdate[k] += upd;
+    else
+      lazyUpdate[k] = upd;
+    lazySet[k] = true;
+  }
+
+  void push(const int k) {
+    if constexpr (lazy) {
+      if (!lazySet[k])
+        return;
+      accumulateUpdate(2 * k, lazyUpdate[k]);
+      accumulateUpdate(2 * k + 1, lazyUpdate[k]);
+      lazySet[k] = false;
+    }
+  }
+
+  // Pushes the pending updates on the paths from the root to the leaves l and
+  // r - 1, i.e. to all the ancestors of the nodes that cover [l, r).
+  void pushBoundaries(const int l, const int r) {
+    if constexpr (!lazy)
+      return;
+    for (int i = log; i > 0; --i) {
+      if (((l >> i) << i) != l)
+        push(l >> i);
+      if (((r >> i) << i) != r)
+        push((r - 1) >> i);
+    }
+  }
+};
+
+// Same as SegmentTree (with the same requirements on Data and UpdateData),
+// except the range of indices can be huge (e.g. [0, 10^18]) and only the nodes
+// that actually get touched by updates are created. That is, the children of
+// a node are created on first touch, so q operations create O(qlgU) nodes,
+// where U is the length of the range.
+//
+// The nodes live in a single arena (vector) and refer to their children by
+// 32-bit indices, so there is no allocation per node.
+//
+// The contents of the untouched parts of the range are given by init(l, r),
+// which must return the accumulated data of the whole range [l, r] (e.g. for
+// the sum tree below, Data{.sum = 0, .rangeLen = r - l + 1}). Note that if the
+// nodes get updated before their children are created, the children are
+// initialized with init and then receive the pending update, so
+// init(l, mid) + init(mid + 1, r) must be consistent with init(l, r).
+//
+// Note: query() doesn't create any nodes. If it reaches a node with no
+// children, the answer for its part of the range is computed directly from
+// init and the pending update of the node.
+//
+// init is called for every created node, so pass its type as InitFn to avoid
+// going through an std::function, e.g.
+//   const auto init = [](i64 l, i64 r) { return Data{0, r - l + 1}; };
+//   DynamicSegmentTree<Data, UpdateData, decltype(init)> tree(init, 0, 1e18);
+template <typename Data, typename UpdateData,
+          typename InitFn = std::function<Data(i64, i64)>>
+class DynamicSegmentTree {
+ public:
+  // Constructs the segment tree on [lo, hi] in O(1) time. expectedNodes can be
+  // used to reserve space in the arena upfront (each update creates at most
+  // about 4lgU nodes).
+  DynamicSegmentTree(const InitFn& init, const i64 lo, const i64 hi,
+                     const int expectedNodes = 0)
+      : init(init), leftmost(lo), rightmost(hi) {
+    nodes.reserve(expectedNodes);
+    nodes.push_back(Node{.data = init(lo, hi)});
+  }
+
+  // Accumulates the data in the range [lo, hi] in O(lgU) time.
+  Data query(const i64 lo, const i64 hi) {
+    return query(0, leftmost, rightmost, lo, hi);
+  }
+
+  // Lazily updates the range [lo, hi] in O(lgU) time.
+  void update(const i64 lo, const i64 hi, const UpdateData& upd) {
+    update(0, leftmost, rightmost, lo, hi, upd);
+  }
+
+  Data pointQuery(const i64 idx) { return query(idx, idx); }
+
+  void pointUpdate(const i64 idx, const UpdateData& upd) {
+    update(idx, idx, upd);
+  }
+
+  // See SegmentTree::query_if.
+  template <typename UnaryPredicate>
+  Data query_if(const i64 lo, const i64 hi, const UnaryPredicate& pred) {
+    return query_if(0, leftmost, rightmost, lo, hi, pred);
+  }
+
+  // See SegmentTree::update_if.
+  template <typename UnaryPredicate>
+  void update_if(const i64 lo, const i64 hi, const UpdateData& upd,
+                 const UnaryPredicate& pred) {
+    update_if(0, leftmost, rightmost, lo, hi, upd, pred);
+  }
+
+  // See SegmentTree::maxRight. If there is no such index, returns one past the
+  // end of the range.
+  template <typename UnaryPredicate>
+  i64 maxRight(i64 lo, const UnaryPredicate& pred) {
+    if (lo > rightmost)
+      return rightmost + 1;
+    lo = std::max(lo, leftmost);
+    // Same as SegmentTree::Node::maxRight.
+    std::array<Segment, maxDepth> cover;
+    int coverCount = 0;
+    auto seg = Segment{0, leftmost, rightmost};
+    while (seg.l != lo) {
+      push(seg.k, seg.l, seg.r);
+      const auto mid = midpoint(seg.l, seg.r);
+      if (lo <= mid) {
+        cover[coverCount++] = Segment{nodes[seg.k].right, mid + 1, seg.r};
+        seg = Segment{nodes[seg.k].left, seg.l, mid};
+      } else {
+        seg = Segment{nodes[seg.k].right, mid + 1, seg.r};
+      }
+    }
+    cover[coverCount++] = seg;
+
+    Data acc;
+    for (int i = coverCount - 1; i >= 0; --i) {
+      seg = cover[i];
+      auto next = acc + nodes[seg.k].data;
+      if (pred(next)) {
+        acc = std::move(next);
+        continue;
+      }
+      while (seg.l != seg.r) {
+        push(seg.k, seg.l, seg.r);
+        const auto mid = midpoint(seg.l, seg.r);
+        next = acc + nodes[nodes[seg.k].left].data;
+        if (pred(next)) {
+          acc = std::move(next);
+          seg = Segment{nodes[seg.k].right, mid + 1, seg.r};
+        } else {
+          seg = Segment{nodes[seg.k].left, seg.l, mid};
+        }
+      }
+      return seg.l;
+    }
+    return rightmost + 1;
+  }
+
+  // See SegmentTree::minLeft. If there is no such index, returns one before the
+  // beginning of the range.
+  template <typename UnaryPredicate>
+  i64 minLeft(i64 hi, const UnaryPredicate& pred) {
+    if (hi < leftmost)
+      return leftmost - 1;
+    hi = std::min(hi, rightmost);
+    std::array<Segment, maxDepth> cover;
+    int coverCount = 0;
+    auto seg = Segment{0, leftmost, rightmost};
+    while (seg.r != hi) {
+      push(seg.k, seg.l, seg.r);
+      const auto mid = midpoint(seg.l, seg.r);
+      if (hi > mid) {
+        cover[coverCount++] = Segment{nodes[seg.k].left, seg.l, mid};
+        seg = Segment{nodes[seg.k].right, mid + 1, seg.r};
+      } else {
+        seg = Segment{nodes[seg.k].left, seg.l, mid};
+      }
+    }
+    cover[coverCount++] = seg;
+
+    Data acc;
+    for (int i = coverCount - 1; i >= 0; --i) {
+      seg = cover[i];
+      auto next = nodes[seg.k].data + acc;
+      if (pred(next)) {
+        acc = std::move(next);
+        continue;
+      }
+      while (seg.l != seg.r) {
+        push(seg.k, seg.l, seg.r);
+        const auto mid = midpoint(seg.l, seg.r);
+        next = nodes[nodes[seg.k].right].data + acc;
+        if (pred(next)) {
+          acc = std::move(next);
+          seg = Segment{nodes[seg.k].left, seg.l, mid};
+        } else {
+          seg = Segment{nodes[seg.k].right, mid + 1, seg.r};
+        }
+      }
+      return seg.r;
+    }
+    return leftmost - 1;
+  }
+
+  // See SegmentTree::lowerBound. If there is no such index, returns one past
+  // the end of the range.
+  template <typename BinaryPredicate>
+  i64 lowerBound(const i64 lo, const Data& target,
+                 const BinaryPredicate& pred) {
+    if (!pred(Data(), target))
+      return lo - 1;
+    return maxRight(lo, [&](const Data& acc) { return pred(acc, target); });
+  }
+
+  // See SegmentTree::upperBound.
+  template <typename BinaryPredicate>
+  i64 upperBound(const i64 lo, const Data& target,
+                 const BinaryPredicate& pred) {
+    if (pred(target, Data()))
+      return lo - 1;
+    return maxRight(lo, [&](const Data& acc) { return !pred(target, acc); });
+  }
+
+  // Returns the number of nodes created so far.
+  int nodeCount() const { return nodes.size(); }
+
+ private:
+  // Node 0 is the root, so it can't be anyone's child and left == 0 means that
+  // the children haven't been created yet.
+  //
+  // Note: nodes is a vector that grows, so don't keep references to its
+  // elements across calls that may create nodes (i.e. push).
+  struct Node {
+    Data data;
+    UpdateData lazyUpdate;
+    int left = 0, right = 0;
+    bool lazySet = false;
+  };
+
+  // A node together with the range it covers.
+  struct Segment {
+    int k;
+    i64 l, r;
+  };
+
+  // The number of nodes on a root-to-leaf path of a tree with i64 sizes (the
+  // leaves of a tree on 2^64 indices are at depth 64).
+  static constexpr int maxDepth = 65;
+
+  InitFn init;
+  i64 leftmost, rightmost;
+  std::vector<Node> nodes;
+
+  // Doesn't overflow even if [l, r] spans all of i64.
+  static i64 midpoint(const i64 l, const i64 r) {
+    return l + i64((uint64_t(r) - uint64_t(l)) / 2);
+  }
+
+  int newNode(const i64 l, const i64 r) {
+    nodes.push_back(Node{.data = init(l, r)});
+    return nodes.size() - 1;
+  }
+
+  // Creates the children of node k (which covers [l, r]) if they don't exist
+  // yet and pushes the pending update of k onto them.
+  void push(const int k, const i64 l, const i64 r) {
+    if (nodes[k].left == 0) {
+      const int leftChild = newNode(l, midpoint(l, r));
+      const int rightChild = newNode(midpoint(l, r) + 1, r);
+      nodes[k].left = leftChild;
+      nodes[k].right = rightChild;
+    }
+    if (!nodes[k].lazySet)
+      return;
+    PROF_COUNT("DynamicSegmentTree::push");
+    accumulateUpdate(nodes[k].left, nodes[k].lazyUpdate);
+    accumulateUpdate(nodes[k].right, nodes[k].lazyUpdate);
+    nodes[k].lazySet = false;
+  }
+
+  void accumulateUpdate(const int k, const UpdateData& upd) {
+    auto& node = nodes[k];
+    node.data += upd;
+    if (node.lazySet)
+      node.lazyUpdate += upd;
+    else
+      node.lazyUpdate = upd;
+    node.lazySet = true;
+  }
+
+  void recompute(const int k) {
+    nodes[k].data = nodes[nodes[k].left].data + nodes[nodes[k].right].data;
+  }
+
+  Data query(const int k, const i64 l, const i64 r, const i64 lo,
+             const i64 hi) {
+    PROF_COUNT("DynamicSegmentTree::visit");
+    if ((hi < l) || (r < lo))
+      return Data();
+    if ((lo <= l) && (r <= hi))
+      return nodes[k].data;
+    if (nodes[k].left == 0) {
+      auto res = init(std::max(l, lo), std::min(r, hi));
+      if (nodes[k].lazySet)
+        res += nodes[k].lazyUpdate;
+      return res;
+    }
+    push(k, l, r);
+    const auto mid = midpoint(l, r);
+    const auto leftAcc = query(nodes[k].left, l, mid, lo, hi);
+    return leftAcc + query(nodes[k].right, mid + 1, r, lo, hi);
+  }
+
+  void update(const int k, const i64 l, const i64 r, const i64 lo,
+              const i64 hi, const UpdateData& upd) {
+    PROF_COUNT("DynamicSegmentTree::visit");
+    if ((hi < l) || (r < lo))
+      return;
+    if ((lo <= l) && (r <= hi)) {
+      accumulateUpdate(k, upd);
+      return;
+    }
+    push(k, l, r);
+    const auto mid = midpoint(l, r);
+    update(nodes[k].left, l, mid, lo, hi, upd);
+    update(nodes[k].right, mid + 1, r, lo, hi, upd);
+    recompute(k);
+  }
+
+  template <typename UnaryPredicate>
+  Data query_if(const int k, const i64 l, const i64 r, const i64 lo,
+                const i64 hi, const UnaryPredicate& pred) {
+    PROF_COUNT("DynamicSegmentTree::visit");
+    if ((hi < l) || (r < lo))
+      return Data();
+    if ((lo <= l) && (r <= hi)) {
+      const auto predVal = pred(nodes[k].data);
+      if (predVal < 0)
+        return Data();
+      if (predVal > 0)
+        return nodes[k].data;
+    }
+    if (l == r)  // If we are a leaf and get here, pred(data) == 0.
+      return Data();
+    push(k, l, r);
+    const auto mid = midpoint(l, r);
+    const auto leftAcc = query_if(nodes[k].left, l, mid, lo, hi, pred);
+    return leftAcc + query_if(nodes[k].right, mid + 1, r, lo, hi, pred);
+  }
+
+  template <typename UnaryPredicate>
+  void update_if(const int k, const i64 l, const i64 r, const i64 lo,
+                 const i64 hi, const UpdateData& upd,
+                 const UnaryPredicate& pred) {
+    PROF_COUNT("DynamicSegmentTree::visit");
+    if ((hi < l) || (r < lo))
+      return;
+    if ((lo <= l) && (r <= hi)) {
+      const auto predVal = pred(nodes[k].data);
+      if (predVal < 0)
+        return;
+      if (predVal > 0) {
+        accumulateUpdate(k, upd);
+        return;
+      }
+    }
+    if (l == r)
+      return;
+    push(k, l, r);
+    const auto mid = midpoint(l, r);
+    update_if(nodes[k].left, l, mid, lo, hi, upd, pred);
+    update_if(nodes[k].right, mid + 1, r, lo, hi, upd, pred);
+    recompute(k);
+  }
+};
+
+// Persistent version of SegmentTree (with the same requirements on Data and
+// UpdateData): every update creates a new version of the array and leaves all
+// the previous versions intact, so queries can be asked about any version.
+//
+// Updates copy the nodes on the paths they visit (path copying) and share
+// all the other subtrees with the previous version, so every update adds only
+// O(lgn) nodes. A pending update isn't pushed onto the original children (they
+// may still belong to some other version), instead it's passed down and
+// applied to the copies of the children, so every touched node is copied
+// exactly once. Queries don't push at all, instead the pending updates of the
+// ancestors get applied to the accumulated result, so they don't allocate.
+//
+// Note: because of that, Data() += upd must be equal to Data().
+//
+// The versions are numbered 0, 1, 2, ... in the order they were created,
+// version 0 being the initial array.
+template <typename Data, typename UpdateData>
+class PersistentSegmentTree {
+ public:
+  // Constructs version 0 of the segment tree on [0, sz) in O(n) time, where
+  // init(i) is the i-th entry in the range.
+  //
+  // WARNING: Cannot create an empty tree, i.e. we must have sz > 0.
+  template <typename InitFn>
+  PersistentSegmentTree(const InitFn& init, const int sz) : sz(sz) {
+    nodes.reserve(2 * sz);
+    roots.push_back(build(init, 0, sz - 1));
+  }
+
+  // Reserves space for the nodes of the given number of updates, each of which
+  // creates at most 4lgn + 1 nodes (the root and at most 4 nodes per level).
+  void reserveUpdates(const int updates) {
+    int log = 1;
+    while ((1 << log) < sz)
+      ++log;
+    nodes.reserve(nodes.size() + i64(updates) * (4 * log + 1));
+  }
+
+  int versionCount() const { return roots.size(); }
+
+  // Accumulates the data in the range [lo, hi] of the given version in O(lgn)
+  // time.
+  Data query(const int version, const int lo, const int hi) const {
+    return query(roots[version], 0, sz - 1, lo, hi);
+  }
+
+  // Creates a new version by lazily updating the range [lo, hi] of the given
+  // version in O(lgn) time. Returns the number of the new version.
+  int update(const int version, const int lo, const int hi,
+             const UpdateData& upd) {
+    roots.push_back(update(roots[version], 0, sz - 1, lo, hi, upd, Pending()));
+    return roots.size() - 1;
+  }
+
+  Data pointQuery(const int version, const int idx) const {
+    return query(version, idx, idx);
+  }
+
+  int pointUpdate(const int version, const int idx, const UpdateData& upd) {
+    return update(version, idx, idx, upd);
+  }
+
+  // Walks down from the roots of versions a and b to a leaf and returns its
+  // index, in O(lgn) time. At every internal node, goLeft(leftA, leftB) decides
+  // whether to continue into the left child, where leftA and leftB are the
+  // Data of the left children in the two versions.
+  //
+  // This is meant for questions about the difference of two versions. For
+  // example, the k-th smallest (0-indexed) element of arr[l..r]: take a tree
+  // over the (compressed) values counting the occurrences, where version i + 1
+  // adds arr[i] to version i. Then the answer is the value at index
+  //   walk(l, r + 1, [&](const Data& a, const Data& b) {
+  //     const auto cnt = b.sum - a.sum;
+  //     if (k < cnt)
+  //       return true;
+  //     k -= cnt;
+  //     return false;
+  //   });
+  template <typename GoLeftFn>
+  int walk(const int a, const int b, const GoLeftFn& goLeft) const {
+    int nodeA = roots[a], nodeB = roots[b], l = 0, r = sz - 1;
+    Pending pendingA, pendingB;
+    while (l < r) {
+      const auto leftA = childData(nodeA, nodes[nodeA].left, pendingA);
+      const auto leftB = childData(nodeB, nodes[nodeB].left, pendingB);
+      pendingA = childPending(nodeA, pendingA);
+      pendingB = childPending(nodeB, pendingB);
+      const auto mid = l + (r - l) / 2;
+      if (goLeft(leftA, leftB)) {
+        nodeA = nodes[nodeA].left;
+        nodeB = nodes[nodeB].left;
+        r = mid;
+      } else {
+        nodeA = nodes[nodeA].right;
+        nodeB = nodes[nodeB].right;
+        l = mid + 1;
+      }
+    }
+    return l;
+  }
+
+  // Returns a vector containg all of the data stored in the given version (in
+  // order). Runs in O(n) time.
+  std::vector<Data> getContents(const int version) const {
+    std::vector<Data> res;
+    res.reserve(sz);
+    getContents(roots[version], 0, sz - 1, Pending(), res);
+    return res;
+  }
+
+ private:
+  struct Node {
+    Data data;
+    UpdateData lazyUpdate;
+    int left = -1, right = -1;
+    bool lazySet = false;
+  };
+
+  // Composition of the pending updates of the ancestors of a node, which
+  // haven't been applied to the node yet.
+  struct Pending {
+    UpdateData upd;
+    bool set = false;
+  };
+
+  int sz;
+  std::vector<Node> nodes;
+  std::vector<int> roots;
+
+  template <typename InitFn>
+  int build(const InitFn& init, const int l, const int r) {
+    if (l == r) {
+      nodes.push_back(Node{.data = init(l)});
+      return nodes.size() - 1;
+    }
+    const auto mid = l + (r - l) / 2;
+    const int left = build(init, l, mid);
+    const int right = build(init, mid + 1, r);
+    nodes.push_back(Node{.data = nodes[left].data + nodes[right].data,
+                         .left = left,
+                         .right = right});
+    return nodes.size() - 1;
+  }
+
+  // Note: nodes is a vector that grows, so don't keep references to its
+  // elements across calls to clone.
+  int clone(const int k) {
+    PROF_COUNT("PersistentSegmentTree::clone");
+    nodes.push_back(nodes[k]);
+    return nodes.size() - 1;
+  }
+
+  void accumulateUpdate(const int k, const UpdateData& upd) {
+    auto& node = nodes[k];
+    node.data += upd;
+    if (node.lazySet)
+      node.lazyUpdate += upd;
+    else
+      node.lazyUpdate = upd;
+    node.lazySet = true;
+  }
+
+  // Returns the root of the updated copy of the subtree k covering [l, r].
+  // pending is the update of the parent of k that hasn't been applied to k
+  // yet, it gets applied to the copy.
+  int update(const int k, const int l, const int r, const int lo,
+             const int hi, const UpdateData& upd, const Pending& pending) {
+    const bool outside = (hi < l) || (r < lo);
+    if (outside && !pending.set)
+      return k;
+    const int copy = clone(k);
+    if (pending.set)
+      accumulateUpdate(copy, pending.upd);
+    if (outside)
+      return copy;
+    if ((lo <= l) && (r <= hi)) {
+      accumulateUpdate(copy, upd);
+      return copy;
+    }
+    // Hand the pending update of the copy down to (the copies of) its
+    // children.
+    const auto childPend =
+        Pending{.upd = nodes[copy].lazyUpdate, .set = nodes[copy].lazySet};
+    nodes[copy].lazySet = false;
+    const auto mid = l + (r - l) / 2;
+    const int left = update(nodes[copy].left, l, mid, lo, hi, upd, childPend);
+    const int right =
+        update(nodes[copy].right, mid + 1, r, lo, hi, upd, childPend);
+    nodes[copy].left = left;
+    nodes[copy].right = right;
+    nodes[copy].data = nodes[left].data + nodes[right].data;
+    return copy;
+  }
+
+  Data query(const int k, const int l, const int r, const int lo,
+             const int hi) const {
+    if ((hi < l) || (r < lo))
+      return Data();
+    if ((lo <= l) && (r <= hi))
+      return nodes[k].data;
+    const auto mid = l + (r - l) / 2;
+    const auto leftAcc = query(nodes[k].left, l, mid, lo, hi);
+    auto res = leftAcc + query(nodes[k].right, mid + 1, r, lo, hi);
+    if (nodes[k].lazySet)
+      res += nodes[k].lazyUpdate;
+    return res;
+  }
+
+  // Returns the data of child (a child of k) with all the pending updates
+  // applied.
+  Data childData(const int k, const int child, const Pending& pending) const {
+    auto res = nodes[child].data;
+    if (nodes[k].lazySet)
+      res += nodes[k].lazyUpdate;
+    if (pending.set)
+      res += pending.upd;
+    return res;
+  }
+
+  // Returns the pending updates of the children of k, given the pending
+  // updates of k itself.
+  Pending childPending(const int k, const Pending& pending) const {
+    if (!nodes[k].lazySet)
+      return pending;
+    auto res = Pending{.upd = nodes[k].lazyUpdate, .set = true};
+    if (pending.set)
+      res.upd += pending.upd;
+    return res;
+  }
+
+  void getContents(const int k, const int l, const int r,
+                   const Pending& pending, std::vector<Data>& res) const {
+    if (l == r) {
+      res.push_back(nodes[k].data);
+      if (pending.set)
+        res.back() += pending.upd;
+      return;
+    }
+    const auto mid = l + (r - l) / 2;
+    const auto childPend = childPending(k, pending);
+    getContents(nodes[k].left, l, mid, childPend, res);
+    getContents(nodes[k].right, mid + 1, r, childPend, res);
+  }
+};
+
+// Segment tree for a single writer and many concurrent readers, where the
+// readers don't take any locks. It supports point updates and range queries
+// (with the same requirements on Data and UpdateData as SegmentTree, except
+// there are no lazy updates, so UpdateData only gets applied to the leaves).
+//
+// The readers query immutable snapshots (flat bottom-up trees like in
+// FlatSegmentTree, without the lazy arrays). The writer buffers its updates
+// and publish() makes them visible: the updates get applied to a snapshot
+// no reader can see, which then atomically replaces the current one (RCU
+// style). An old snapshot gets reused by the writer only after all the
+// readers which could have seen it are done (epoch-based reclamation), and it
+// is brought up to date by replaying the batches of updates it missed. So a
+// publish() costs O(blgn) for b buffered updates (plus O(n) for copying the
+// current snapshot the first couple of times, while there are less than three
+// snapshots). If all the old snapshots are still in use, publish() waits for
+// the readers to finish with one of them.
+//
+// Every reader thread must use its own reader id from [0, readers), the ids
+// are what makes the reads lock-free.
+//
+// For example:
+//   ConcurrentSegmentTree<Data, UpdateData> tree(init, n, readers);
+//   // Reader thread id:
+//   const auto sum = tree.query(id, lo, hi).sum;
+//   // Writer thread:
+//   tree.pointUpdate(idx, upd);
+//   tree.publish();
+template <typename Data, typename UpdateData>
+class ConcurrentSegmentTree {
+ private:
+  struct Version;
+
+ public:
+  // Constructs the segment tree on [0, sz) in O(n) time, where init(i) is the
+  // i-th entry in the range.
+  template <typename InitFn>
+  ConcurrentSegmentTree(const InitFn& init, const int sz, const int readers)
+      : sz(sz), readerSlots(readers) {
+    while (size < sz)
+      size *= 2;
+    auto version = std::make_unique<Version>();
+    version->data = std::vector<Data>(2 * size);
+    for (int i = 0; i < sz; ++i)
+      version->data[size + i] = init(i);
+    for (int k = size - 1; k > 0; --k)
+      version->data[k] = version->data[2 * k] + version->data[2 * k + 1];
+    current.store(version.get());
+    versions.push_back(std::move(version));
+  }
+
+  // A consistent view of the tree for one reader. The snapshot stays valid
+  // (and doesn't change) until it is destroyed, so several queries can be
+  // asked about the same state of the tree.
+  //
+  // Note: a reader may hold only one Snapshot at a time.
+  class Snapshot {
+   public:
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    ~Snapshot() { slot.store(0, std::memory_order_release); }
+
+    // Accumulates the data in the range [lo, hi] in O(lgn) time.
+    Data query(const int lo, const int hi) const {
+      const auto& data = version->data;
+      Data leftAcc, rightAcc;
+      for (int l = lo + size, r = hi + 1 + size; l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+          leftAcc = leftAcc + data[l++];
+        if (r & 1)
+          rightAcc = data[--r] + rightAcc;
+      }
+      return leftAcc + rightAcc;
+    }
+
+   private:
+    friend class ConcurrentSegmentTree;
+
+    std::atomic<i64>& slot;
+    const Version* version;
+    const int size;
+
+    Snapshot(std::atomic<i64>& slot, const Version* version, const int size)
+        : slot(slot), version(version), size(size) {}
+  };
+
+  // Reader side: returns the most recently published snapshot.
+  Snapshot snapshot(const int reader) const {
+    auto& slot = readerSlots[reader].epoch;
+    // Announce the epoch before loading the snapshot, so that the writer
+    // either sees the announcement or we see the newer snapshot.
+    slot.store(epoch.load());
+    return Snapshot(slot, current.load(), size);
+  }
+
+  // Reader side: accumulates the data in the range [lo, hi] of the most
+  // recently published snapshot in O(lgn) time.
+  Data query(const int reader, const int lo, const int hi) const {
+    return snapshot(reader).query(lo, hi);
+  }
+
+  // Writer side: buffers the update of the entry at index idx, it becomes
+  // visible to the readers on the next publish().
+  void pointUpdate(const int idx, const UpdateData& upd) {
+    pending.emplace_back(idx, upd);
+  }
+
+  // Writer side: makes all the buffered updates visible to the readers.
+  void publish() {
+    if (pending.empty())
+      return;
+    batches.push_back(std::move(pending));
+    pending.clear();
+    const i64 newVersion = firstBatch + batches.size();
+
+    Version* next = reusableVersion();
+    // Keep the memory bounded: once there are enough versions, wait for the
+    // readers to let go of one of them (the reads are short) instead of making
+    // another copy.
+    while (next == nullptr && versions.size() >= maxVersions) {
+      PROF_COUNT("ConcurrentSegmentTree::wait");
+      std::this_thread::yield();
+      next = reusableVersion();
+    }
+    if (next == nullptr) {
+      PROF_COUNT("ConcurrentSegmentTree::copy");
+      auto copy = std::make_unique<Version>(*current.load());
+      next = copy.get();
+      versions.push_back(std::move(copy));
+    }
+    for (i64 batch = next->version; batch < newVersion; ++batch) {
+      for (const auto& [idx, upd] : batches[batch - firstBatch])
+        applyUpdate(*next, idx, upd);
+    }
+    next->version = newVersion;
+
+    // The epoch has to change after the snapshot does: a reader which
+    // announces the new epoch must not be able to load the old snapshot.
+    Version* old = current.exchange(next);
+    const i64 newEpoch = epoch.load() + 1;
+    epoch.store(newEpoch);
+    old->retireEpoch = newEpoch;
+
+    // Forget the batches every version has already seen.
+    i64 oldest = newVersion;
+    for (const auto& version : versions)
+      oldest = std::min(oldest, version->version);
+    while (firstBatch < oldest) {
+      batches.pop_front();
+      ++firstBatch;
+    }
+  }
+
+ private:
+  struct Version {
+    std::vector<Data> data;
+    // The number of batches applied to data.
+    i64 version = 0;
+    // The readers which announced an epoch >= retireEpoch can't see this
+    // version.
+    i64 retireEpoch = 0;
+  };
+
+  struct alignas(64) ReaderSlot {
+    // The epoch announced by the reader, or 0 if it's not reading.
+    std::atomic<i64> epoch{0};
+  };
+
+  static constexpr int maxVersions = 3;
+
+  int sz, size = 1;
+  mutable std::vector<ReaderSlot> readerSlots;
+  std::atomic<i64> epoch{1};
+  std::atomic<Version*> current;
+
+  // The rest is only touched by the writer.
+  std::vector<std::unique_ptr<Version>> versions;
+  std::vector<std::pair<int, UpdateData>> pending;
+  // batches[i] is the batch which produced version firstBatch + i + 1.
+  std::deque<std::vector<std::pair<int, UpdateData>>> batches;
+  i64 firstBatch = 0;
+
+  // Returns the most recent old version which no reader can see anymore (or
+  // nullptr if there's none).
+  Version* reusableVersion() {
+    i64 minEpoch = std::numeric_limits<i64>::max();
+    for (const auto& slot : readerSlots) {
+      const i64 announced = slot.epoch.load();
+      if (announced != 0)
+        minEpoch = std::min(minEpoch, announced);
+    }
+    Version* res = nullptr;
+    for (const auto& version : versions) {
+      if (version.get() == current.load() || version->retireEpoch > minEpoch)
+        continue;
+      if (res == nullptr || version->version > res->version)
+        res = version.get();
+    }
+    return res;
+  }
+
+  void applyUpdate(Version& version, const int idx, const UpdateData& upd) {
+    auto& data = version.data;
+    int k = idx + size;
+    data[k] += upd;
+    for (k >>= 1; k > 0; k >>= 1)
+      data[k] = data[2 * k] + data[2 * k + 1];
+  }
+};
+
+// The built-in associative (and commutative) operations for WideSegmentTree.
+// SumOp also works for a Data-like struct with a commutative operator+ and
+// Data() as the neutral element.
+template <typename T>
+struct SumOp {
+  static constexpr T neutral() { return T(); }
+  static constexpr T combine(const T a, const T b) { return a + b; }
+};
+
+template <typename T>
+struct MinOp {
+  static constexpr T neutral() { return std::numeric_limits<T>::max(); }
+  static constexpr T combine(const T a, const T b) { return std::min(a, b); }
+};
+
+template <typename T>
+struct MaxOp {
+  static constexpr T neutral() { return std::numeric_limits<T>::lowest(); }
+  static constexpr T combine(const T a, const T b) { return std::max(a, b); }
+};
+
+template <typename T>
+struct XorOp {
+  static constexpr T neutral() { return T(0); }
+  static constexpr T combine(const T a, const T b) { return a ^ b; }
+};
+
+// Segment tree for plain numbers T under one of the operations above, which
+// supports range queries and setting single elements. Instead of a binary
+// tree, it is a B-ary one with B = 64 / sizeof(T) (e.g. 16 for int), so every
+// node is exactly one cache line: level 0 holds the elements, and the j-th
+// element of level i + 1 is the accumulation of the j-th block of B elements
+// of level i.
+//
+// A query accumulates parts of at most two blocks per level, i.e. short loops
+// over contiguous memory within a single (64-byte aligned) cache line, and
+// there are only log_B(n) levels. That makes it faster than the binary trees
+// when there are no range updates: compared to DefFlatSegmentTree on 10^6 to
+// 10^7 random operations, about 1.5x for queries and 2x for point updates (and
+// 10x or more for both compared to DefSegmentTree), see benchWideSegmentTree in
+// Benchmark.cpp.
+//
+// The interface matches SegmentTree only partially: construction and
+// query(lo, hi) work the same, but there is set(idx, val) instead of
+// pointUpdate and no range updates, maxRight etc. Also, the accumulation order
+// within a level isn't left to right, so the operation must be commutative.
+// T can be a plain number or a Data-like struct used with SumOp (operator+
+// and Data() as the neutral element), so e.g.
+//   using Tree = WideSegmentTree<Data, SumOp<Data>>;
+// can replace DefSegmentTree in code that only builds, queries and sets. Keep
+// in mind that B = 64 / sizeof(T), i.e. a 16-byte Data gives B = 4 only.
+template <typename T, typename Op>
+class WideSegmentTree {
+ public:
+  static constexpr int B = std::max<int>(1, 64 / sizeof(T));
+
+  // Constructs the segment tree on [0, sz) in O(n) time, where init(i) is the
+  // i-th entry in the range.
+  template <typename InitFn>
+  WideSegmentTree(const InitFn& init, const int sz) {
+    levels.emplace_back(blockCount(sz) * B, Op::neutral());
+    for (int i = 0; i < sz; ++i)
+      levels[0][i] = init(i);
+    for (int len = sz; len > B; len = blockCount(len)) {
+      auto next = Level(blockCount(blockCount(len)) * B, Op::neutral());
+      for (int j = 0; j < blockCount(len); ++j)
+        next[j] = reduce(levels.back().data() + j * B, 0, B - 1);
+      levels.push_back(std::move(next));
+    }
+  }
+
+  // Accumulates the data in the range [lo, hi] in O(Blog_B(n)) time.
+  T query(int lo, int hi) const {
+    T acc = Op::neutral();
+    for (int level = 0;; ++level) {
+      const T* values = levels[level].data();
+      const int loBlock = lo / B, hiBlock = hi / B;
+      if (loBlock == hiBlock) {
+        return Op::combine(acc,
+                           reduce(values + loBlock * B, lo % B, hi % B));
+      }
+      acc = Op::combine(acc, reduce(values + loBlock * B, lo % B, B - 1));
+      acc = Op::combine(acc, reduce(values + hiBlock * B, 0, hi % B));
+      // The blocks strictly between the two are handled by the next level.
+      lo = loBlock + 1;
+      hi = hiBlock - 1;
+      if (lo > hi)
+        return acc;
+    }
+  }
+
+  T pointQuery(const int idx) const { return levels[0][idx]; }
+
+  // Sets the entry at index idx to val in O(Blog_B(n)) time.
+  void set(int idx, const T val) {
+    levels[0][idx] = val;
+    for (int level = 1; level < levels.size(); ++level) {
+      idx /= B;
+      levels[level][idx] =
+          reduce(levels[level - 1].data() + idx * B, 0, B - 1);
+    }
+  }
+
+ private:
+  using Level = std::vector<T, AlignedAllocator<T>>;
+
+  // levels[0] holds the elements, the top level fits into a single block. All
+  // the levels are padded to whole blocks with Op::neutral().
+  std::vector<Level> levels;
+
+  static int blockCount(const int len) { return (len + B - 1) / B; }
+
+  // Accumulates block[from..to]. When the whole block gets accumulated (as in
+  // set()), the loop has a fixed length and gets vectorized.
+  static T reduce(const T* block, const int from, const int to) {
+    T acc = Op::neutral();
+    for (int i = from; i <= to; ++i)
+      acc = Op::combine(acc, block[i]);
+    return acc;
+  }
 };
 
 // Structure that stores all data necessary to update a segment (range).
@@ -399,4 +1837,7 @@ struct Data {
 };
 
 // Default Segment Tree (used with the data structures defined above).
-using DefSegmentTree = SegmentTree<Data, UpdateData>;
\ No newline at end of file
+using DefSegmentTree = SegmentTree<Data, UpdateData>;
+using DefFlatSegmentTree = FlatSegmentTree<Data, UpdateData>;
+using DefDynamicSegmentTree = DynamicSegmentTree<Data, UpdateData>;
+using DefPersistentSegmentTree = PersistentSegmentTree<Data, UpdateData>;
\ No newline at end of file
@@ -0,0 +1,252 @@
+// Segment Tree Beats (Ji's segment tree) supporting the range updates
+//  a[i] = min(a[i], x), a[i] = max(a[i], x) and a[i] += x
+// together with range sum, max and min queries.
+//
+// Unlike SegmentTree::update_if (which has no complexity guarantee and may
+// visit every leaf, e.g. when clamping an alternating high/low array over and
+// over), chmin/chmax only descend into a node if the update changes at least
+// two distinct values in it, which gives an amortized running time of
+// O((n + q)lg^2n) for q operations (O((n + q)lgn) without add()).
+//
+// Every node keeps the largest and second largest values (and the count of the
+// largest), the same for the smallest, and the sum. The nodes are stored in a
+// flat array like in FlatSegmentTree (the children of node k are 2k and
+// 2k + 1), but the operations are recursive.
+//
+// Note: the sums must fit into T.
+template <typename T = i64>
+class SegmentTreeBeats {
+ public:
+  // Constructs the segment tree on [0, sz) in O(n) time, where init(i) is the
+  // i-th entry in the range.
+  //
+  // WARNING: Cannot create an empty tree, i.e. we must have sz > 0.
+  template <typename InitFn>
+  SegmentTreeBeats(const InitFn& init, const int sz) : sz(sz) {
+    int size = 1;
+    while (size < sz)
+      size *= 2;
+    nodes = std::vector<Node>(2 * size);
+    build(init, 1, 0, sz - 1);
+  }
+
+  // Sets a[i] = min(a[i], x) for i in [lo, hi].
+  void chmin(const int lo, const int hi, const T x) {
+    chmin(1, 0, sz - 1, lo, hi, x);
+  }
+
+  // Sets a[i] = max(a[i], x) for i in [lo, hi].
+  void chmax(const int lo, const int hi, const T x) {
+    chmax(1, 0, sz - 1, lo, hi, x);
+  }
+
+  // Adds x to a[i] for i in [lo, hi].
+  void add(const int lo, const int hi, const T x) {
+    add(1, 0, sz - 1, lo, hi, x);
+  }
+
+  T querySum(const int lo, const int hi) {
+    return query(1, 0, sz - 1, lo, hi, T(0),
+                 [](const Node& node) { return node.sum; }, std::plus<T>());
+  }
+
+  T queryMax(const int lo, const int hi) {
+    return query(
+        1, 0, sz - 1, lo, hi, NEG_INF<T>,
+        [](const Node& node) { return node.max1; },
+        [](const T a, const T b) { return std::max(a, b); });
+  }
+
+  T queryMin(const int lo, const int hi) {
+    return query(
+        1, 0, sz - 1, lo, hi, POS_INF<T>,
+        [](const Node& node) { return node.min1; },
+        [](const T a, const T b) { return std::min(a, b); });
+  }
+
+ private:
+  // max2 == NEG_INF (min2 == POS_INF) means that all the values in the node
+  // are equal to max1 (min1).
+  struct Node {
+    T sum;
+    T max1, max2;
+    T min1, min2;
+    T lazyAdd;
+    int maxCount, minCount;
+  };
+
+  int sz;
+  std::vector<Node> nodes;
+
+  template <typename InitFn>
+  void build(const InitFn& init, const int k, const int l, const int r) {
+    if (l == r) {
+      const T val = init(l);
+      nodes[k] = Node{.sum = val,
+                      .max1 = val,
+                      .max2 = NEG_INF<T>,
+                      .min1 = val,
+                      .min2 = POS_INF<T>,
+                      .lazyAdd = 0,
+                      .maxCount = 1,
+                      .minCount = 1};
+      return;
+    }
+    const int mid = l + (r - l) / 2;
+    build(init, 2 * k, l, mid);
+    build(init, 2 * k + 1, mid + 1, r);
+    recompute(k);
+  }
+
+  void recompute(const int k) {
+    auto& node = nodes[k];
+    const auto& left = nodes[2 * k];
+    const auto& right = nodes[2 * k + 1];
+    node.sum = left.sum + right.sum;
+    node.lazyAdd = 0;
+
+    if (left.max1 == right.max1) {
+      node.max1 = left.max1;
+      node.max2 = std::max(left.max2, right.max2);
+      node.maxCount = left.maxCount + right.maxCount;
+    } else if (left.max1 > right.max1) {
+      node.max1 = left.max1;
+      node.max2 = std::max(left.max2, right.max1);
+      node.maxCount = left.maxCount;
+    } else {
+      node.max1 = right.max1;
+      node.max2 = std::max(left.max1, right.max2);
+      node.maxCount = right.maxCount;
+    }
+
+    if (left.min1 == right.min1) {
+      node.min1 = left.min1;
+      node.min2 = std::min(left.min2, right.min2);
+      node.minCount = left.minCount + right.minCount;
+    } else if (left.min1 < right.min1) {
+      node.min1 = left.min1;
+      node.min2 = std::min(left.min2, right.min1);
+      node.minCount = left.minCount;
+    } else {
+      node.min1 = right.min1;
+      node.min2 = std::min(left.min1, right.min2);
+      node.minCount = right.minCount;
+    }
+  }
+
+  void applyAdd(const int k, const int len, const T x) {
+    auto& node = nodes[k];
+    node.sum += x * len;
+    node.max1 += x;
+    if (node.max2 != NEG_INF<T>)
+      node.max2 += x;
+    node.min1 += x;
+    if (node.min2 != POS_INF<T>)
+      node.min2 += x;
+    node.lazyAdd += x;
+  }
+
+  // Lowers the maximum of the node to x, where max2 < x < max1 (so only the
+  // occurrences of max1 change).
+  void applyChmin(const int k, const T x) {
+    auto& node = nodes[k];
+    node.sum -= (node.max1 - x) * node.maxCount;
+    if (node.min1 == node.max1)
+      node.min1 = x;
+    else if (node.min2 == node.max1)
+      node.min2 = x;
+    node.max1 = x;
+  }
+
+  // Raises the minimum of the node to x, where min1 < x < min2.
+  void applyChmax(const int k, const T x) {
+    auto& node = nodes[k];
+    node.sum += (x - node.min1) * node.minCount;
+    if (node.max1 == node.min1)
+      node.max1 = x;
+    else if (node.max2 == node.min1)
+      node.max2 = x;
+    node.min1 = x;
+  }
+
+  // Pushes the pending add and the clamping of node k (which covers [l, r])
+  // onto its children. The children which have larger maximums (or smaller
+  // minimums) than node k got clamped.
+  void push(const int k, const int l, const int r) {
+    PROF_COUNT("SegmentTreeBeats::push");
+    const int mid = l + (r - l) / 2;
+    if (nodes[k].lazyAdd != 0) {
+      applyAdd(2 * k, mid - l + 1, nodes[k].lazyAdd);
+      applyAdd(2 * k + 1, r - mid, nodes[k].lazyAdd);
+      nodes[k].lazyAdd = 0;
+    }
+    for (const int child : {2 * k, 2 * k + 1}) {
+      if (nodes[child].max1 > nodes[k].max1)
+        applyChmin(child, nodes[k].max1);
+      if (nodes[child].min1 < nodes[k].min1)
+        applyChmax(child, nodes[k].min1);
+    }
+  }
+
+  void chmin(const int k, const int l, const int r, const int lo,
+             const int hi, const T x) {
+    PROF_COUNT("SegmentTreeBeats::visit");
+    if ((hi < l) || (r < lo) || (nodes[k].max1 <= x))
+      return;
+    if ((lo <= l) && (r <= hi) && (nodes[k].max2 < x)) {
+      applyChmin(k, x);
+      return;
+    }
+    push(k, l, r);
+    const int mid = l + (r - l) / 2;
+    chmin(2 * k, l, mid, lo, hi, x);
+    chmin(2 * k + 1, mid + 1, r, lo, hi, x);
+    recompute(k);
+  }
+
+  void chmax(const int k, const int l, const int r, const int lo,
+             const int hi, const T x) {
+    PROF_COUNT("SegmentTreeBeats::visit");
+    if ((hi < l) || (r < lo) || (nodes[k].min1 >= x))
+      return;
+    if ((lo <= l) && (r <= hi) && (nodes[k].min2 > x)) {
+      applyChmax(k, x);
+      return;
+    }
+    push(k, l, r);
+    const int mid = l + (r - l) / 2;
+    chmax(2 * k, l, mid, lo, hi, x);
+    chmax(2 * k + 1, mid + 1, r, lo, hi, x);
+    recompute(k);
+  }
+
+  void add(const int k, const int l, const int r, const int lo, const int hi,
+           const T x) {
+    PROF_COUNT("SegmentTreeBeats::visit");
+    if ((hi < l) || (r < lo))
+      return;
+    if ((lo <= l) && (r <= hi)) {
+      applyAdd(k, r - l + 1, x);
+      return;
+    }
+    push(k, l, r);
+    const int mid = l + (r - l) / 2;
+    add(2 * k, l, mid, lo, hi, x);
+    add(2 * k + 1, mid + 1, r, lo, hi, x);
+    recompute(k);
+  }
+
+  // Accumulates get(node) with combine over the nodes covering [lo, hi].
+  template <typename GetFn, typename CombineFn>
+  T query(const int k, const int l, const int r, const int lo, const int hi,
+          const T neutral, const GetFn& get, const CombineFn& combine) {
+    if ((hi < l) || (r < lo))
+      return neutral;
+    if ((lo <= l) && (r <= hi))
+      return get(nodes[k]);
+    push(k, l, r);
+    const int mid = l + (r - l) / 2;
+    return combine(query(2 * k, l, mid, lo, hi, neutral, get, combine),
+                   query(2 * k + 1, mid + 1, r, lo, hi, neutral, get, combine));
+  }
+};
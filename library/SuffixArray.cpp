@@ -36,6 +36,7 @@ class SuffixArray {
   };
 
   SuffixArray(std::string_view sv, Mode mode) {
+    PROF_SCOPE("SuffixArray::build");
     suffArr = std::move(suffixLogSquared(sv, mode));
     constructLcp(sv);
   }
@@ -127,6 +128,7 @@ class SuffixArray {
     };
 
     for (int halfLen = 1; halfLen < size; halfLen *= 2) {
+      PROF_COUNT("SuffixArray::doublingRound");
       std::sort(sorted.begin(), sorted.end(), [&](auto i, auto j) {
         return std::tie(equivClass[idx(i - halfLen)], equivClass[i]) <
                std::tie(equivClass[idx(j - halfLen)], equivClass[j]);
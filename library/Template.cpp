@@ -1,15 +1,23 @@
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <charconv>
 #include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <deque>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
 #include <queue>
@@ -19,11 +27,22 @@
 #include <stack>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if __has_include(<sys/resource.h>)
+#include <sys/resource.h>
+#endif
+
 #include "stdafx.h"
 
 // http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2016/p0200r0.html
@@ -46,13 +65,394 @@ decltype(auto) y_combinator(Fun&& fun) {
   return y_combinator_result<std::decay_t<Fun>>(std::forward<Fun>(fun));
 }
 
+// ------------------------------------------------------------
+// Profiling stuff.
+// ------------------------------------------------------------
+
+// Named counters and scoped timers for finding out where the time goes, e.g.
+//   PROF_COUNT("SegmentTree::push");        // Counts the executions.
+//   PROF_ADD("UnionFind::pathLength", len); // Adds len to the counter.
+//   PROF_SCOPE("dijkstra");                 // Times the enclosing scope.
+// The counters are accumulated per thread and the totals get printed to
+// stderr at the end of the program.
+//
+// The macros only do anything if ENABLE_PROFILING is defined (e.g. compile
+// with -DENABLE_PROFILING), otherwise they expand to nothing so the generated
+// code is the same as without them.
+#ifdef ENABLE_PROFILING
+class ProfRegistry {
+ public:
+  static ProfRegistry& get() {
+    static ProfRegistry registry;
+    return registry;
+  }
+
+  void merge(const char* name, int64_t count, int64_t ns) {
+    std::lock_guard lock(m);
+    auto& [totalCount, totalNs] = totals[name];
+    totalCount += count;
+    totalNs += ns;
+  }
+
+  ~ProfRegistry() {
+    std::lock_guard lock(m);
+    std::cerr << "---- profile ----\n";
+    for (const auto& [name, stats] : totals) {
+      std::cerr << name << ": " << stats.first;
+      if (stats.second > 0)
+        std::cerr << " (" << stats.second / 1e6 << " ms)";
+      std::cerr << '\n';
+    }
+  }
+
+ private:
+  std::mutex m;
+  std::map<std::string, std::pair<int64_t, int64_t>> totals;
+};
+
+// Per thread (and per call site) accumulator, merged into the registry when
+// the thread exits.
+struct ProfSlot {
+  explicit ProfSlot(const char* name) : name(name) {
+    // Makes sure the registry outlives the slot.
+    ProfRegistry::get();
+  }
+  ~ProfSlot() { ProfRegistry::get().merge(name, count, ns); }
+
+  const char* name;
+  int64_t count = 0;
+  int64_t ns = 0;
+};
+
+class ProfTimer {
+ public:
+  explicit ProfTimer(ProfSlot& slot)
+      : slot(slot), start(std::chrono::steady_clock::now()) {}
+  ~ProfTimer() {
+    ++slot.count;
+    slot.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  }
+
+ private:
+  ProfSlot& slot;
+  std::chrono::steady_clock::time_point start;
+};
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_ADD(name, x)                         \
+  do {                                            \
+    static thread_local ProfSlot profSlot_(name); \
+    profSlot_.count += (x);                       \
+  } while (0)
+#define PROF_COUNT(name) PROF_ADD(name, 1)
+#define PROF_SCOPE(name)                                               \
+  static thread_local ProfSlot PROF_CONCAT(profSlot_, __LINE__)(name); \
+  ProfTimer PROF_CONCAT(profTimer_, __LINE__)(PROF_CONCAT(profSlot_, __LINE__))
+#else
+#define PROF_ADD(name, x)
+#define PROF_COUNT(name)
+#define PROF_SCOPE(name)
+#endif
+
+// Reads the whole of stdin at once (mmap-ing it if stdin is a regular file) and
+// parses the tokens by hand. On inputs of a few MB this is several times faster
+// than std::cin, even with sync_with_stdio(false).
+//
+// Supports integral types, floating point types, chars, std::strings and
+// pairs of those. The input is only read upon the first extraction, starting
+// from the current position of the file (so whatever got read through scanf
+// etc. before that is skipped).
+//
+// WARNING: the scanner swallows all of stdin, so do not mix it with std::cin.
+// Not even before the first extraction: with sync_with_stdio(false), std::cin
+// buffers input on its own, and the scanner has no way of knowing how much of
+// it std::cin actually consumed.
+class Scanner {
+ public:
+  // Reads from file instead of stdin.
+  explicit Scanner(FILE* file = stdin) : file(file) {}
+  Scanner(const Scanner&) = delete;
+  Scanner& operator=(const Scanner&) = delete;
+
+  ~Scanner() {
+#if __has_include(<sys/mman.h>)
+    if (mapped)
+      munmap(const_cast<char*>(begin), end - begin);
+#endif
+  }
+
+  template <typename T>
+  std::enable_if_t<std::is_integral_v<T>, Scanner&> operator>>(T& x) {
+    skipWhitespace();
+    bool negative = false;
+    if ((cur < end) && ((*cur == '-') || (*cur == '+'))) {
+      negative = (*cur == '-');
+      ++cur;
+    }
+    std::make_unsigned_t<T> res = 0;
+    for (; (cur < end) && (*cur >= '0') && (*cur <= '9'); ++cur)
+      res = res * 10 + (*cur - '0');
+    x = negative ? T(-res) : T(res);
+    return *this;
+  }
+
+  template <typename T>
+  std::enable_if_t<std::is_floating_point_v<T>, Scanner&> operator>>(T& x) {
+    skipWhitespace();
+    // strtod needs a null-terminated string, which an mmap-ed file isn't.
+    char buf[64];
+    int len = 0;
+    for (; (cur < end) && (*cur > ' ') && (len < 63); ++cur)
+      buf[len++] = *cur;
+    buf[len] = '\0';
+    x = std::strtod(buf, nullptr);
+    return *this;
+  }
+
+  Scanner& operator>>(char& c) {
+    skipWhitespace();
+    c = (cur < end) ? *cur++ : '\0';
+    return *this;
+  }
+
+  Scanner& operator>>(std::string& s) {
+    skipWhitespace();
+    const auto tokenBegin = cur;
+    while ((cur < end) && (*cur > ' '))
+      ++cur;
+    s.assign(tokenBegin, cur);
+    return *this;
+  }
+
+  template <typename T, typename U>
+  Scanner& operator>>(std::pair<T, U>& p) {
+    return *this >> p.first >> p.second;
+  }
+
+ private:
+  const char* begin = nullptr;
+  const char* cur = nullptr;
+  const char* end = nullptr;
+  FILE* file;
+  bool loaded = false;
+  bool mapped = false;
+  // Used only if stdin could not be mmap-ed (e.g. it's a pipe).
+  std::vector<char> buffer;
+
+  void skipWhitespace() {
+    if (!loaded)
+      load();
+    while ((cur < end) && (*cur <= ' '))
+      ++cur;
+  }
+
+  void load() {
+    loaded = true;
+#if __has_include(<sys/mman.h>)
+    struct stat st;
+    const int fd = fileno(file);
+    // ftello (unlike lseek on fd) takes into account what the FILE buffered.
+    const off_t offset = ftello(file);
+    if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (offset >= 0) &&
+        (st.st_size > offset)) {
+      void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        mapped = true;
+        begin = static_cast<const char*>(data);
+        cur = begin + offset;
+        end = begin + st.st_size;
+        return;
+      }
+    }
+#endif
+    buffer.resize(1 << 16);
+    size_t size = 0;
+    for (;;) {
+      size += std::fread(buffer.data() + size, 1, buffer.size() - size, file);
+      if (size < buffer.size())
+        break;
+      buffer.resize(2 * buffer.size());
+    }
+    cur = begin = buffer.data();
+    end = begin + size;
+  }
+};
+
+inline Scanner scanner;
+
+// The types that std::ostream writes as characters rather than as numbers.
+template <typename T>
+inline constexpr bool isCharType = std::is_same_v<T, char> ||
+                                   std::is_same_v<T, signed char> ||
+                                   std::is_same_v<T, unsigned char>;
+
+// The longest decimal representation of an integer of type T (with the sign).
+template <typename T>
+inline constexpr int maxIntLen = std::numeric_limits<T>::digits10 + 2;
+
+// Writes the decimal representation of the integer x starting at p and returns
+// the pointer one past the last written char. There has to be room for at
+// least maxIntLen<T> chars at p.
+//
+// Emits two digits at a time using a table of digit pairs, so it's quite a bit
+// faster than going through an std::ostream.
+inline constexpr auto digitPairs = [] {
+  std::array<char, 200> res{};
+  for (int i = 0; i < 100; ++i) {
+    res[2 * i] = '0' + i / 10;
+    res[2 * i + 1] = '0' + i % 10;
+  }
+  return res;
+}();
+
+template <typename T>
+char* formatInt(char* p, T x) {
+  if constexpr (std::is_same_v<T, bool>) {
+    *p = '0' + x;
+    return p + 1;
+  } else {
+    std::make_unsigned_t<T> u = x;
+    if constexpr (std::is_signed_v<T>) {
+      if (x < 0) {
+        *p++ = '-';
+        u = -u;
+      }
+    }
+
+    // Fill the digits from the back, then copy them over.
+    char tmp[maxIntLen<T>];
+    char* q = tmp + maxIntLen<T>;
+    for (; u >= 100; u /= 100) {
+      q -= 2;
+      std::memcpy(q, &digitPairs[2 * (u % 100)], 2);
+    }
+    if (u >= 10) {
+      q -= 2;
+      std::memcpy(q, &digitPairs[2 * u], 2);
+    } else {
+      *--q = '0' + u;
+    }
+
+    const auto len = tmp + maxIntLen<T> - q;
+    std::memcpy(p, q, len);
+    return p + len;
+  }
+}
+
+// Buffered replacement for std::cout. Integers are formatted by hand, doubles
+// are formatted like std::cout << std::setprecision(12) would do. The buffer
+// is flushed when full and at the end of the program.
+//
+// WARNING: do not mix with std::cout, the output would end up out of order.
+class Writer {
+ public:
+  Writer() = default;
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  ~Writer() { flush(); }
+
+  void flush() {
+    writeOut();
+    std::fflush(stdout);
+  }
+
+  // Same as std::setprecision, i.e. the number of significant digits. Capped
+  // at maxPrecision (way beyond the precision of a long double), so that any
+  // floating point number fits into the buffer.
+  void setPrecision(int prec) { precision = std::min(prec, maxPrecision); }
+
+  // Note: signed char and unsigned char go to operator<<(char) instead, so
+  // they get written as characters, like with std::cout.
+  template <typename T>
+  std::enable_if_t<std::is_integral_v<T> && !isCharType<T>, Writer&>
+  operator<<(T x) {
+    reserve(maxIntLen<T>);
+    pos = formatInt(buf + pos, x) - buf;
+    return *this;
+  }
+
+  template <typename T>
+  std::enable_if_t<std::is_floating_point_v<T>, Writer&> operator<<(T x) {
+    // snprintf returns the full length even if the output got truncated.
+    int len = std::snprintf(buf + pos, bufSize - pos, "%.*Lg", precision,
+                            (long double)x);
+    if (pos + len >= bufSize) {
+      writeOut();
+      len = std::snprintf(buf, bufSize, "%.*Lg", precision, (long double)x);
+    }
+    pos += len;
+    return *this;
+  }
+
+  Writer& operator<<(char c) {
+    reserve(1);
+    buf[pos++] = c;
+    return *this;
+  }
+
+  Writer& operator<<(std::string_view sv) {
+    if (sv.size() > bufSize) {
+      writeOut();
+      std::fwrite(sv.data(), 1, sv.size(), stdout);
+      return *this;
+    }
+    reserve(sv.size());
+    std::memcpy(buf + pos, sv.data(), sv.size());
+    pos += sv.size();
+    return *this;
+  }
+
+  Writer& operator<<(const char* s) { return *this << std::string_view(s); }
+
+  Writer& operator<<(const std::string& s) {
+    return *this << std::string_view(s);
+  }
+
+  template <typename T, typename U>
+  Writer& operator<<(const std::pair<T, U>& p) {
+    return *this << p.first << ' ' << p.second;
+  }
+
+  template <typename T>
+  Writer& operator<<(const std::vector<T>& vec) {
+    for (const auto& i : vec)
+      *this << i << ' ';
+    return *this;
+  }
+
+ private:
+  static constexpr int bufSize = 1 << 16;
+  static constexpr int maxPrecision = 1000;
+
+  char buf[bufSize];
+  int pos = 0;
+  int precision = 12;
+
+  // Makes sure that there is room for len more chars in the buffer.
+  void reserve(int len) {
+    if (pos + len > bufSize)
+      writeOut();
+  }
+
+  void writeOut() {
+    std::fwrite(buf, 1, pos, stdout);
+    pos = 0;
+  }
+};
+
+inline Writer writer;
+
 template <typename T>
 std::vector<T> readVecSz(const int sz) {
   std::vector<T> res;
   res.reserve(sz);
   for (int i = 0; i < sz; ++i) {
     T tmp;
-    std::cin >> tmp;
+    scanner >> tmp;
     res.push_back(std::move(tmp));
   }
   return res;
@@ -64,7 +464,7 @@ std::vector<T> readVecSz(const int sz, const Func& f) {
   res.reserve(sz);
   for (int i = 0; i < sz; ++i) {
     T tmp;
-    std::cin >> tmp;
+    scanner >> tmp;
     res.push_back(std::move(f(tmp)));
   }
   return res;
@@ -73,14 +473,14 @@ std::vector<T> readVecSz(const int sz, const Func& f) {
 template <typename T>
 std::vector<T> readVec() {
   int sz;
-  std::cin >> sz;
+  scanner >> sz;
   return readVecSz<T>(sz);
 }
 
 template <typename T, typename Func>
 std::vector<T> readVec(const Func& f) {
   int sz;
-  std::cin >> sz;
+  scanner >> sz;
   return readVecSz<T>(sz, f);
 }
 
@@ -96,42 +496,342 @@ std::vector<std::vector<T>> readMatSz(const int rows, const int cols) {
 template <typename T>
 std::vector<std::vector<T>> readMat() {
   int m, n;
-  std::cin >> m >> n;
+  scanner >> m >> n;
   return readMatSz<T>(m, n);
 }
 
-std::vector<std::vector<int>> readGraph(const int vertices, const int edges,
-                                        const bool directed) {
-  auto g = std::vector<std::vector<int>>(vertices, std::vector<int>());
+// Allocator handing out memory aligned to Align bytes (a cache line by
+// default).
+template <typename T, size_t Align = 64>
+struct AlignedAllocator {
+  using value_type = T;
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Align>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+  T* allocate(const size_t n) {
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t(Align)));
+  }
+  void deallocate(T* p, size_t) {
+    ::operator delete(p, std::align_val_t(Align));
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Align>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Align>&) const {
+    return false;
+  }
+};
+
+// Row-major matrix stored in a single contiguous, cache line aligned block of
+// memory, i.e. a (much more cache-friendly) replacement for
+// std::vector<std::vector<T>>.
+//
+// Both mat(r, c) and mat[r][c] work, the latter since mat[r] returns a
+// pointer to the beginning of the row r.
+//
+// If padRows is set, each row gets padded to a multiple of the cache line size
+// so that all rows start at a cache line boundary.
+//
+// WARNING: doesn't work with T == bool (because of std::vector<bool>), use
+// char instead.
+template <typename T>
+class Matrix {
+ public:
+  Matrix() = default;
+
+  Matrix(const int rows, const int cols, const T& val = T(),
+         const bool padRows = false)
+      : rowCount(rows), colCount(cols), rowStride(cols) {
+    if (padRows) {
+      constexpr int perLine = std::max<int>(1, 64 / sizeof(T));
+      rowStride = (cols + perLine - 1) / perLine * perLine;
+    }
+    storage.assign(size_t(rowCount) * rowStride, val);
+  }
+
+  int rows() const { return rowCount; }
+  int cols() const { return colCount; }
+  // Distance (in elements) between the beginnings of two consecutive rows.
+  int stride() const { return rowStride; }
+
+  T& operator()(const int r, const int c) {
+    return storage[size_t(r) * rowStride + c];
+  }
+  const T& operator()(const int r, const int c) const {
+    return storage[size_t(r) * rowStride + c];
+  }
+
+  T* operator[](const int r) { return storage.data() + size_t(r) * rowStride; }
+  const T* operator[](const int r) const {
+    return storage.data() + size_t(r) * rowStride;
+  }
+
+ private:
+  int rowCount = 0, colCount = 0, rowStride = 0;
+  std::vector<T, AlignedAllocator<T>> storage;
+};
+
+// Same as readMatSz, but returns a flat Matrix.
+template <typename T>
+Matrix<T> readMatSzFlat(const int rows, const int cols,
+                        const bool padRows = false) {
+  auto res = Matrix<T>(rows, cols, T(), padRows);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j)
+      scanner >> res(i, j);
+  }
+  return res;
+}
+
+// Same as readMat, but returns a flat Matrix.
+template <typename T>
+Matrix<T> readMatFlat(const bool padRows = false) {
+  int m, n;
+  scanner >> m >> n;
+  return readMatSzFlat<T>(m, n, padRows);
+}
+
+// Resizes adj to n empty adjacency lists. The first n lists keep their memory.
+// If spare is given, the lists cut off when shrinking are moved there and taken
+// from there when growing again, so nothing gets freed. (Pass the same spare on
+// every call, e.g. one per thread.)
+template <typename Edge>
+void clearAdjacencyLists(std::vector<std::vector<Edge>>& adj, const int n,
+                         std::vector<std::vector<Edge>>* spare = nullptr) {
+  if (spare) {
+    for (; adj.size() > n; adj.pop_back())
+      spare->push_back(std::move(adj.back()));
+    for (; (adj.size() < n) && !spare->empty(); spare->pop_back())
+      adj.push_back(std::move(spare->back()));
+  }
+  adj.resize(n);
+  for (auto& neighbors : adj)
+    neighbors.clear();
+}
+
+// Same as readGraph below, except the graph gets read into g. The adjacency
+// lists of g get cleared but not freed (see clearAdjacencyLists for spare), so
+// reading every test case into the same g allocates (almost) nothing after the
+// first few cases.
+void readGraphInto(std::vector<std::vector<int>>& g, const int vertices,
+                   const int edges, const bool directed,
+                   std::vector<std::vector<int>>* spare = nullptr) {
+  clearAdjacencyLists(g, vertices, spare);
   for (int i = 0; i < edges; ++i) {
     int u, v;
-    std::cin >> u >> v;
+    scanner >> u >> v;
     --u;
     --v;
     g[u].push_back(v);
     if (!directed)
       g[v].push_back(u);
   }
+}
+
+std::vector<std::vector<int>> readGraph(const int vertices, const int edges,
+                                        const bool directed) {
+  std::vector<std::vector<int>> g;
+  readGraphInto(g, vertices, edges, directed);
   return g;
 }
 
+// Same as readGraphInto, but for readGraphWeighted.
 template <typename Weight = int>
-std::vector<std::vector<std::pair<int, Weight>>> readGraphWeighted(
-    const int vertices, const int edges, const bool directed) {
-  auto g = std::vector<std::vector<std::pair<int, Weight>>>(vertices);
+void readGraphWeightedInto(
+    std::vector<std::vector<std::pair<int, Weight>>>& g, const int vertices,
+    const int edges, const bool directed,
+    std::vector<std::vector<std::pair<int, Weight>>>* spare = nullptr) {
+  clearAdjacencyLists(g, vertices, spare);
   for (int i = 0; i < edges; ++i) {
     int u, v;
     Weight w;
-    std::cin >> u >> v >> w;
+    scanner >> u >> v >> w;
     --u;
     --v;
     g[u].emplace_back(v, w);
     if (!directed)
       g[v].emplace_back(u, w);
   }
+}
+
+template <typename Weight = int>
+std::vector<std::vector<std::pair<int, Weight>>> readGraphWeighted(
+    const int vertices, const int edges, const bool directed) {
+  std::vector<std::vector<std::pair<int, Weight>>> g;
+  readGraphWeightedInto(g, vertices, edges, directed);
   return g;
 }
 
+// Edge of a weighted graph, the neighbor id and the weight of the edge to it.
+// This is what the weighted graph algorithms (e.g. dijkstra in GraphAlgs.cpp)
+// expect as the edge type.
+template <typename Weight = int>
+struct WeightedEdge {
+  int id;
+  Weight w;
+};
+
+// Graph in the compressed sparse row format, i.e. the neighbors of vertex u
+// are stored in edges[offsets[u]], ..., edges[offsets[u + 1] - 1] of a single
+// flat array. Compared to std::vector<std::vector<Edge>>, there's no allocation
+// per vertex and the traversals are much more cache-friendly.
+//
+// Supports the same adj[u] range interface (and adj.size()) as the
+// vector-of-vectors graphs, so the functions in GraphAlgs.cpp work on it.
+// Edge is int for unweighted graphs and WeightedEdge<Weight> for weighted ones
+// (see readCsrGraph and readCsrGraphWeighted below).
+template <typename Edge = int>
+class CsrGraph {
+ public:
+  // Contiguous range of the edges going out of a single vertex.
+  class Range {
+   public:
+    Range(const Edge* first, const Edge* last) : first(first), last(last) {}
+    const Edge* begin() const { return first; }
+    const Edge* end() const { return last; }
+    int size() const { return last - first; }
+    bool empty() const { return first == last; }
+    const Edge& operator[](int i) const { return first[i]; }
+
+   private:
+    const Edge *first, *last;
+  };
+
+  CsrGraph() = default;
+
+  // Builds the graph on the given number of vertices from the edge list
+  // from[i] -> to[i] in O(V + E) time (using a counting sort on the from's).
+  // The relative order of the out-edges of each vertex is preserved.
+  CsrGraph(const int vertices, const std::vector<int>& from,
+           const std::vector<Edge>& to) {
+    build(vertices, from, to);
+  }
+
+  // (Re-) builds the graph from the edge list that fillEdges(from, to) appends
+  // to the (empty) vectors from and to. Those are buffers kept in the graph, so
+  // rebuilding the same graph allocates only when it grows.
+  template <typename FillFn>
+  void buildWith(const int vertices, const FillFn& fillEdges) {
+    edgeFrom.clear();
+    edgeTo.clear();
+    fillEdges(edgeFrom, edgeTo);
+    build(vertices, edgeFrom, edgeTo);
+  }
+
+  // (Re-) builds the graph, see the constructor above.
+  void build(const int vertices, const std::vector<int>& from,
+             const std::vector<Edge>& to) {
+    // First pass: offsets[u] = number of edges going out of vertices <= u.
+    offsets.assign(vertices + 1, 0);
+    for (auto u : from)
+      ++offsets[u];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    // Second pass: place the edges going backwards, so that afterwards
+    // offsets[u] points at the first edge of u.
+    edges.resize(to.size());
+    for (int i = int(from.size()) - 1; i >= 0; --i)
+      edges[--offsets[from[i]]] = to[i];
+  }
+
+  int size() const { return int(offsets.size()) - 1; }
+  int edgeCount() const { return edges.size(); }
+
+  Range operator[](const int u) const {
+    return Range(edges.data() + offsets[u], edges.data() + offsets[u + 1]);
+  }
+
+ private:
+  std::vector<int> offsets;
+  std::vector<Edge> edges;
+  // Edge list buffers of buildWith.
+  std::vector<int> edgeFrom;
+  std::vector<Edge> edgeTo;
+};
+
+// Reads the edge list of a graph (with both directions of the undirected
+// edges) and appends it to from and to, see readCsrGraph. Edge is either int or
+// WeightedEdge.
+template <typename Edge>
+void readEdgeList(std::vector<int>& from, std::vector<Edge>& to,
+                  const int edges, const bool directed) {
+  from.reserve(from.size() + (directed ? edges : 2 * edges));
+  to.reserve(to.size() + (directed ? edges : 2 * edges));
+  for (int i = 0; i < edges; ++i) {
+    int u, v;
+    scanner >> u >> v;
+    --u;
+    --v;
+    if constexpr (std::is_same_v<Edge, int>) {
+      from.push_back(u);
+      to.push_back(v);
+      if (!directed) {
+        from.push_back(v);
+        to.push_back(u);
+      }
+    } else {
+      decltype(Edge::w) w;
+      scanner >> w;
+      from.push_back(u);
+      to.push_back({v, w});
+      if (!directed) {
+        from.push_back(v);
+        to.push_back({u, w});
+      }
+    }
+  }
+}
+
+// Same as readGraphInto, except reads the graph in the CSR format. Since the
+// CsrGraph keeps its arrays and edge list buffers (see CsrGraph::buildWith),
+// reading every test case into the same g allocates only when the graph grows.
+void readCsrGraphInto(CsrGraph<int>& g, const int vertices, const int edges,
+                      const bool directed) {
+  g.buildWith(vertices, [&](std::vector<int>& from, std::vector<int>& to) {
+    readEdgeList(from, to, edges, directed);
+  });
+}
+
+// Same as readGraph, except returns the graph in the CSR format.
+CsrGraph<int> readCsrGraph(const int vertices, const int edges,
+                           const bool directed) {
+  std::vector<int> from, to;
+  readEdgeList(from, to, edges, directed);
+  return CsrGraph<int>(vertices, from, to);
+}
+
+// Same as readCsrGraphInto, but for weighted graphs.
+template <typename Weight = int>
+void readCsrGraphWeightedInto(CsrGraph<WeightedEdge<Weight>>& g,
+                              const int vertices, const int edges,
+                              const bool directed) {
+  g.buildWith(vertices, [&](std::vector<int>& from,
+                            std::vector<WeightedEdge<Weight>>& to) {
+    readEdgeList(from, to, edges, directed);
+  });
+}
+
+// Same as readGraphWeighted, except returns the graph in the CSR format.
+template <typename Weight = int>
+CsrGraph<WeightedEdge<Weight>> readCsrGraphWeighted(const int vertices,
+                                                    const int edges,
+                                                    const bool directed) {
+  std::vector<int> from;
+  std::vector<WeightedEdge<Weight>> to;
+  readEdgeList(from, to, edges, directed);
+  return CsrGraph<WeightedEdge<Weight>>(vertices, from, to);
+}
+
 template <typename T, typename U>
 std::istream& operator>>(std::istream& is, std::pair<T, U>& p) {
   is >> p.first >> p.second;
@@ -192,8 +892,72 @@ struct hash<pair<T, U>> {
 };
 }  // namespace std
 
+// Stable LSD radix sort of vec by key(x), where key returns an unsigned
+// integer of which only the lowest keyBits bits are used. Goes over 11 bits
+// at a time and skips the passes in which all keys share the same digit, so
+// it runs in O(n * keyBits / 11) time.
+template <typename T, typename KeyFn>
+void radixSort(std::vector<T>& vec, const KeyFn& key, const int keyBits) {
+  constexpr int digitBits = 11;
+  constexpr int digitCount = 1 << digitBits;
+  const int passes = (keyBits + digitBits - 1) / digitBits;
+
+  // Cheap enough to check and (already) sorted inputs are common.
+  if (std::is_sorted(vec.begin(), vec.end(), [&](const T& x, const T& y) {
+        return key(x) < key(y);
+      }))
+    return;
+
+  // Compute the histograms of all the passes in a single go.
+  auto counts = std::vector<std::array<int, digitCount>>(passes);
+  for (const auto& x : vec) {
+    const auto k = key(x);
+    for (int p = 0; p < passes; ++p)
+      ++counts[p][(k >> (p * digitBits)) & (digitCount - 1)];
+  }
+
+  auto buf = std::vector<T>(vec.size());
+  for (int p = 0; p < passes; ++p) {
+    auto& cnt = counts[p];
+    if (std::find(cnt.begin(), cnt.end(), int(vec.size())) != cnt.end())
+      continue;  // All the elements have the same digit.
+    int sum = 0;
+    for (auto& c : cnt)
+      sum += std::exchange(c, sum);
+    for (auto& x : vec)
+      buf[cnt[(key(x) >> (p * digitBits)) & (digitCount - 1)]++] = std::move(x);
+    vec.swap(buf);
+  }
+}
+
+// Maps an integer to an unsigned one so that the order is preserved (i.e.
+// flips the sign bit of signed ints).
+template <typename T>
+std::make_unsigned_t<T> radixKey(const T x) {
+  using U = std::make_unsigned_t<T>;
+  if constexpr (std::is_signed_v<T>)
+    return U(x) ^ (U(1) << (8 * sizeof(T) - 1));
+  else
+    return x;
+}
+
+// Whether sortedCopy/sortedTracedCopy should use radixSort: only for
+// integers sorted with the default comparator (and not too short vectors).
+template <typename T, typename Comp>
+bool useRadixSort(const std::vector<T>& vec) {
+  if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                std::is_same_v<Comp, std::less<T>>)
+    return vec.size() >= 256;
+  return false;
+}
+
 template <typename T, typename Comp = std::less<T>>
 std::vector<T> sortedCopy(std::vector<T> vec, Comp comp = std::less<T>{}) {
+  if (useRadixSort<T, Comp>(vec)) {
+    if constexpr (std::is_integral_v<T>)
+      radixSort(vec, radixKey<T>, 8 * sizeof(T));
+    return vec;
+  }
   std::sort(vec.begin(), vec.end(), comp);
   return vec;
 }
@@ -207,16 +971,48 @@ std::vector<std::pair<int, T>> sortedTracedCopy(const std::vector<T>& vec,
   cpy.reserve(vec.size());
   for (int i = 0; i < vec.size(); ++i)
     cpy.emplace_back(i, vec[i]);
-  std::stable_sort(cpy.begin(), cpy.end(), [&](const auto& p1, const auto& p2) {
-    return comp(p1.second, p2.second);
-  });  // TODO: change it to normal sort with tiebreaking using the p1.firsts?
+  if (useRadixSort<T, Comp>(vec)) {
+    if constexpr (std::is_integral_v<T>) {
+      radixSort(
+          cpy, [](const auto& p) { return radixKey<T>(p.second); },
+          8 * sizeof(T));
+    }
+    return cpy;
+  }
+  // Ties are broken by the original index, which makes the sort stable.
+  std::sort(cpy.begin(), cpy.end(), [&](const auto& p1, const auto& p2) {
+    if (comp(p1.second, p2.second))
+      return true;
+    if (comp(p2.second, p1.second))
+      return false;
+    return p1.first < p2.first;
+  });
   return cpy;
 }
 
 template <typename T>
 std::ostream& operator<<(std::ostream& os, const std::vector<T>& vec) {
-  for (auto i : vec)
-    os << i << ' ';
+  // The char-sized types (other than bool) are left to the stream, which
+  // prints them as characters.
+  if constexpr (std::is_integral_v<T> &&
+                ((sizeof(T) > 1) || std::is_same_v<T, bool>)) {
+    // Format by hand and hand over the chars in large chunks, the stream's
+    // per-element formatting is slow for long vectors.
+    char buf[1 << 12];
+    int pos = 0;
+    for (T i : vec) {
+      if (pos + maxIntLen<T> + 1 > sizeof(buf)) {
+        os.write(buf, pos);
+        pos = 0;
+      }
+      pos = formatInt(buf + pos, i) - buf;
+      buf[pos++] = ' ';
+    }
+    os.write(buf, pos);
+  } else {
+    for (auto i : vec)
+      os << i << ' ';
+  }
   return os;
 }
 
@@ -246,7 +1042,7 @@ int main() {
   std::cout << std::setprecision(12);
 
   int t = 1;
-  // std::cin >> t;
+  // scanner >> t;
   for (int _testCase = 0; _testCase < t; ++_testCase) {
   }
 }
\ No newline at end of file
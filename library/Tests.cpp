@@ -0,0 +1,86 @@
+// Regression tests for the library: each test builds a small case, compares
+// the result with a brute force or a hand-computed answer and asserts. Run
+// them with "./tests.sh", which pastes this file together with the template
+// and the libraries (like benchmark.sh does for BenchmarkMain.cpp).
+//
+// Note: requires Template.cpp, HashMap.cpp, Fenwick.cpp, SegmentTree.cpp and
+// SegmentTreeBeats.cpp.
+
+// update_if on a tree that was rebuilt with fewer elements: the nodes that
+// became leaves still own their (stale) children, which must not be touched.
+void testSegmentTreeUpdateIfAfterRebuild() {
+  DefSegmentTree tree([](int i) { return Data{.sum = 100 + i, .rangeLen = 1}; },
+                      4);
+  std::vector<i64> vals = {1, 2, 3};
+  tree.rebuild([&](int i) { return Data{.sum = vals[i], .rangeLen = 1}; }, 3);
+  // Only the leaves with even sums get updated, pred is 0 on the other ones.
+  tree.update_if(0, 2, UpdateData{.val = 10}, [](const Data& data) {
+    return ((data.rangeLen == 1) && (data.sum % 2 == 0)) ? 1 : 0;
+  });
+  vals[1] += 10;
+  const auto contents = tree.getContents();
+  assert(contents.size() == vals.size());
+  for (int i = 0; i < vals.size(); ++i)
+    assert(contents[i].sum == vals[i]);
+  assert(tree.query(0, 2).sum == vals[0] + vals[1] + vals[2]);
+}
+
+// getElement/setElement against sum, including the out of range index -1.
+void testFenwickGetSetElement() {
+  const std::vector<i64> vals = {5, -3, 0, 7, 2, 2, -1, 4, 9};
+  Fenwick<i64> fen(vals);
+  for (int i = -1; i < int(vals.size()); ++i)
+    assert(fen.getElement(i) == fen.sum(i) - fen.sum(i - 1));
+  fen.setElement(-1, 42);
+  fen.setElement(3, 1);
+  assert(fen.getElement(-1) == 0);
+  assert(fen.getElement(3) == 1);
+  assert(fen.sum(int(vals.size()) - 1) == 25 - 6);
+}
+
+// Random chmin/chmax/add updates and sum/max/min queries against a plain array.
+void testSegmentTreeBeats() {
+  std::mt19937 rng(1);
+  for (int iter = 0; iter < 200; ++iter) {
+    const int n = 1 + rng() % 50;
+    std::vector<i64> vals(n);
+    for (auto& x : vals)
+      x = i64(rng() % 41) - 20;
+    SegmentTreeBeats<i64> tree([&](int i) { return vals[i]; }, n);
+    for (int op = 0; op < 200; ++op) {
+      int lo = rng() % n, hi = rng() % n;
+      if (lo > hi)
+        std::swap(lo, hi);
+      const i64 x = i64(rng() % 41) - 20;
+      const auto first = vals.begin() + lo, last = vals.begin() + hi + 1;
+      switch (rng() % 4) {
+        case 0:
+          tree.chmin(lo, hi, x);
+          for (int i = lo; i <= hi; ++i)
+            vals[i] = std::min(vals[i], x);
+          break;
+        case 1:
+          tree.chmax(lo, hi, x);
+          for (int i = lo; i <= hi; ++i)
+            vals[i] = std::max(vals[i], x);
+          break;
+        case 2:
+          tree.add(lo, hi, x);
+          for (int i = lo; i <= hi; ++i)
+            vals[i] += x;
+          break;
+        default:
+          assert(tree.querySum(lo, hi) == std::accumulate(first, last, i64(0)));
+          assert(tree.queryMax(lo, hi) == *std::max_element(first, last));
+          assert(tree.queryMin(lo, hi) == *std::min_element(first, last));
+      }
+    }
+  }
+}
+
+int main() {
+  testSegmentTreeUpdateIfAfterRebuild();
+  testSegmentTreeBeats();
+  testFenwickGetSetElement();
+  std::cout << "All tests passed." << std::endl;
+}
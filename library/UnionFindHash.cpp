@@ -1,3 +1,7 @@
+// Disjoint Set Union structure over arbitrary int ids, with the sets created
+// on the first access.
+//
+// Note: requires HashMap.cpp.
 class UnionFind {
  public:
   int getSet(int i) {
@@ -43,16 +47,26 @@ class UnionFind {
 
   bool exists(int i) { return parent.count(i) > 0; }
 
+  // Removes all the sets, keeping the allocated capacity for reuse.
+  void clear() {
+    parent.clear();
+    rank.clear();
+    size.clear();
+  }
+
  private:
-  std::unordered_map<int, int> parent;
-  std::unordered_map<int, int> rank;
-  std::unordered_map<int, int> size;
+  HashMap<int, int> parent;
+  HashMap<int, int> rank;
+  HashMap<int, int> size;
+  // The path scratch of findCompress, kept around to avoid reallocating it.
+  std::vector<int> stack;
 
   int findCompress(int i) {
     // Iterative version
-    std::vector<int> stack{i};
+    stack.assign(1, i);
     for (; parent[i] != i; i = parent[i])
       stack.push_back(parent[i]);
+    PROF_ADD("UnionFind::pathLength", stack.size() - 1);
     auto root = stack.back();
     for (auto i : stack)
       parent[i] = root;
@@ -1,62 +1,87 @@
-// Disjoint Set Union structure.
+// Disjoint Set Union structure with union by size and path halving, i.e.
+// (practically) O(1) amortized per operation.
+//
+// Everything lives in a single int array: parent[i] >= 0 is the parent of i,
+// while parent[i] < 0 means that i is a root of a set of size -parent[i]. No
+// allocations happen after construction (or after reset()).
 //
 // For an example, see task 1468J--Road Reform on Codeforces.
 class UnionFind {
  public:
-  UnionFind(int n) : parent(n, -1), rank(n, 0), size(n, 1) {
-    std::iota(parent.begin(), parent.end(), 0);
-  }
+  UnionFind(int n) : parent(n, -1) {}
+
+  // Resets the structure to n singletons. Reuses the existing array, so there
+  // is no allocation unless n exceeds all the previous sizes.
+  void reset(int n) { parent.assign(n, -1); }
 
+  // Returns the representative of the set of i (or -1 if i is out of range).
   int getSet(int i) {
-    if (i < parent.size())
-      return findCompress(i);
+    if (valid(i))
+      return findRoot(i);
     return -1;
   }
 
   int getSize(int i) {
     const auto set = getSet(i);
-    if (set < parent.size())
-      return size[set];
+    if (set >= 0)
+      return -parent[set];
     return -1;
   }
 
-  void unionize(int i, int j) {
-    if (i == j)
-      return;
+  // Returns false if i or j is out of range.
+  bool same(int i, int j) {
+    return valid(i) && valid(j) && (findRoot(i) == findRoot(j));
+  }
 
-    const auto root1 = getSet(i);
-    const auto root2 = getSet(j);
+  // Merges the sets of i and j. Returns false if they were already the same
+  // (or if i or j is out of range).
+  bool unionize(int i, int j) {
+    if (!valid(i) || !valid(j))
+      return false;
+    auto root1 = findRoot(i);
+    auto root2 = findRoot(j);
     if (root1 == root2)
-      return;
-
-    const auto sz = getSize(root1) + getSize(root2);
-    if (rank[root1] > rank[root2])
-      parent[root2] = root1;
-    else if (rank[root1] < rank[root2])
-      parent[root1] = root2;
-    else {
-      parent[root2] = root1;
-      ++rank[root1];
-    }
+      return false;
 
-    size[getSet(i)] = sz;
+    // Hang the smaller set under the larger one.
+    if (parent[root1] > parent[root2])
+      std::swap(root1, root2);
+    parent[root1] += parent[root2];
+    parent[root2] = root1;
+    return true;
+  }
+
+  // Batch version of unionize: res[k] == unionize(pairs[k].first,
+  // pairs[k].second), with the pairs merged in order.
+  std::vector<bool> unionize(const std::vector<std::pair<int, int>>& pairs) {
+    auto res = std::vector<bool>(pairs.size());
+    for (int k = 0; k < pairs.size(); ++k)
+      res[k] = unionize(pairs[k].first, pairs[k].second);
+    return res;
+  }
+
+  // Batch version of same.
+  std::vector<bool> same(const std::vector<std::pair<int, int>>& pairs) {
+    auto res = std::vector<bool>(pairs.size());
+    for (int k = 0; k < pairs.size(); ++k)
+      res[k] = same(pairs[k].first, pairs[k].second);
+    return res;
   }
 
  private:
   std::vector<int> parent;
-  std::vector<int> rank;
-  std::vector<int> size;
 
-  int findCompress(int i) {
-    // Iterative version.
-    std::vector<int> stack{i};
-    for (; parent[i] != i; i = parent[i])
-      stack.push_back(parent[i]);
+  bool valid(int i) const { return (i >= 0) && (i < parent.size()); }
 
-    const auto root = stack.back();
-    for (auto i : stack)
-      parent[i] = root;
-
-    return root;
+  // Path halving: every other node on the path gets pointed at its
+  // grandparent.
+  int findRoot(int i) {
+    while (parent[i] >= 0) {
+      if (parent[parent[i]] >= 0)
+        parent[i] = parent[parent[i]];
+      i = parent[i];
+      PROF_COUNT("UnionFind::pathLength");
+    }
+    return i;
   }
-};
\ No newline at end of file
+};
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Pastes BenchmarkMain.cpp together with the template and the libraries it
+# needs (like one would do for a solution), compiles it and runs it. The
+# arguments get passed on, e.g.
+#   ./benchmark.sh 10000000 > results.jsonl
+set -e
+cd "$(dirname "$0")"
+out="${TMPDIR:-/tmp}/libraryBenchmark"
+mkdir -p "$out"
+# Template.cpp includes the precompiled header stdafx.h, an empty one will do.
+: > "$out/stdafx.h"
+{
+  # The main of the template gets renamed, BenchmarkMain.cpp provides one.
+  tr -d '\r' < Template.cpp |
+    sed 's/^int main() {$/[[maybe_unused]] static void templateMain() {/'
+  echo
+  for f in HashMap.cpp RMQ.cpp Fenwick.cpp SegmentTree.cpp SegmentTreeBeats.cpp \
+      UnionFindVector.cpp SuffixArray.cpp AhoCorasick.cpp GraphAlgs.cpp \
+      Benchmark.cpp BenchmarkMain.cpp; do
+    tr -d '\r' < "$f"
+    echo
+  done
+} > "$out/main.cpp"
+g++ -std=gnu++20 -O2 -I"$out" -o "$out/benchmark" "$out/main.cpp"
+# The recursive DFS's need a large stack on the path graphs.
+ulimit -s unlimited 2>/dev/null || true
+"$out/benchmark" "$@"
@@ -0,0 +1,23 @@
+#!/bin/sh
+# Pastes Tests.cpp together with the template and the libraries it needs,
+# compiles it (with the sanitizers on) and runs it.
+set -e
+cd "$(dirname "$0")"
+out="${TMPDIR:-/tmp}/libraryTests"
+mkdir -p "$out"
+# Template.cpp includes the precompiled header stdafx.h, an empty one will do.
+: > "$out/stdafx.h"
+{
+  # The main of the template gets renamed, Tests.cpp provides one.
+  tr -d '\r' < Template.cpp |
+    sed 's/^int main() {$/[[maybe_unused]] static void templateMain() {/'
+  echo
+  for f in HashMap.cpp Fenwick.cpp SegmentTree.cpp SegmentTreeBeats.cpp \
+      Tests.cpp; do
+    tr -d '\r' < "$f"
+    echo
+  done
+} > "$out/main.cpp"
+g++ -std=gnu++20 -O1 -g -fsanitize=address,undefined -I"$out" \
+  -o "$out/tests" "$out/main.cpp"
+"$out/tests"